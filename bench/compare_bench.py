@@ -0,0 +1,69 @@
+import json
+import sys
+
+# Compares two sim_bench result files and flags throughput regressions
+# usage: python3 bench/compare_bench.py baseline.json current.json [tolerance, default 0.10]
+
+
+def index_runs(results):
+    runs = {}
+    for run in results["runs"]:
+        if run["completed"]:
+            runs[(run["scheduler"], run["processes"])] = run
+    return runs
+
+
+def index_parses(results):
+    return {parse["processes"]: parse for parse in results["parse"]}
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("usage: compare_bench.py baseline.json current.json [tolerance]")
+        return 2
+
+    with open(sys.argv[1]) as f:
+        baseline = json.load(f)
+    with open(sys.argv[2]) as f:
+        current = json.load(f)
+    tolerance = float(sys.argv[3]) if len(sys.argv) > 3 else 0.10
+
+    print(f"baseline {baseline['commit']} -> current {current['commit']} (tolerance {tolerance:.0%})")
+    print(f"{'Metric':<28} | {'Baseline':>14} | {'Current':>14} | {'Change':>8}")
+    print("-" * 74)
+
+    regressions = 0
+
+    def compare(name, old, new, higher_is_better=True):
+        nonlocal regressions
+        change = (new - old) / old if old else 0.0
+        worse = -change if higher_is_better else change
+        flag = "  REGRESSION" if worse > tolerance else ""
+        if flag:
+            regressions += 1
+        print(f"{name:<28} | {old:14.1f} | {new:14.1f} | {change:+7.1%}{flag}")
+
+    old_parses = index_parses(baseline)
+    for processes, parse in sorted(index_parses(current).items()):
+        if processes in old_parses:
+            compare(f"parse MB/s {processes}", old_parses[processes]["mb_per_second"], parse["mb_per_second"])
+
+    old_runs = index_runs(baseline)
+    for key, run in sorted(index_runs(current).items()):
+        if key in old_runs:
+            scheduler, processes = key
+            compare(f"{scheduler} events/s {processes}", old_runs[key]["events_per_second"], run["events_per_second"])
+            compare(f"{scheduler} peak RSS KB {processes}", old_runs[key]["peak_rss_kb"], run["peak_rss_kb"], False)
+
+    # a run that completed before but not anymore is always a regression
+    for key in old_runs:
+        if key not in index_runs(current):
+            print(f"{key[0]} {key[1]}: no longer completes  REGRESSION")
+            regressions += 1
+
+    print(f"\n{regressions} regression(s)")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,357 @@
+/**
+ * @file pcb_layout_bench.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Compares the old array-of-PCBs simulation state against the structure-of-arrays process table
+ *
+ * Both layouts hold the same fields, the PCB of the baseline simulators (baseline_pcb below), so the
+ * comparison measures the layout and not the fields added to PCB since. They run the same scheduler
+ * tick on a table of 1M processes (by default): sweep the wait queue for finished I/O, dispatch from
+ * the ready queue and run the CPU for one ms. The AoS variant copies PCBs between queues like the
+ * baseline simulators did, the SoA variant moves 32-bit indices and only reads the hot columns, with
+ * the cold fields in a baseline_pcb per process as process_table keeps them. Cache misses are read
+ * through perf_event_open when the kernel allows it.
+ *
+ * The tick is a model of the scheduler, so the real Simulator is timed as well, on a generated trace
+ * of the same size (workload_generator.hpp, every process arriving at 0) for the same number of ms.
+ *
+ * Build: cmake --build build --target pcb_layout_bench
+ * Run:   ./bin/pcb_layout_bench [processes] [ticks]
+ */
+
+#include <simulator.hpp>
+#include <workload_generator.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Hardware cache-miss counter for the calling thread, -1 if perf events are not permitted
+int open_cache_miss_counter()
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+struct bench_result
+{
+    double seconds;
+    long long cache_misses; // -1 when unavailable
+    unsigned long long checksum;
+};
+
+// The PCB as the baseline simulators had it, before the priority, fairness and I/O profile fields
+struct baseline_pcb
+{
+    int PID;
+    unsigned int size;
+    unsigned int arrival_time;
+    int start_time;
+    unsigned int processing_time;
+    unsigned int remaining_time;
+    int partition_number;
+    enum states state;
+    unsigned int io_freq;
+    unsigned int io_duration;
+
+    unsigned int time_slice_time;
+    unsigned int io_return_time;
+    unsigned int time_since_io;
+};
+
+// The process table of the SoA variant, process_table with baseline_pcb as the cold record
+struct baseline_table
+{
+    std::vector<uint32_t> remaining_time;
+    std::vector<uint32_t> time_since_io;
+    std::vector<uint16_t> time_slice_time;
+    std::vector<uint32_t> io_return_time;
+    std::vector<uint8_t> state;
+
+    std::vector<baseline_pcb> pcb;
+};
+
+// idle_CPU() on the baseline PCB
+void idle_CPU(baseline_pcb &running)
+{
+    running = baseline_pcb();
+    running.state = NOT_ASSIGNED;
+    running.PID = -1;
+}
+
+// Deterministic workload: every process starts blocked on I/O, about two of them return per tick
+std::vector<baseline_pcb> make_processes(uint32_t count)
+{
+    std::mt19937 rng(4001);
+    std::vector<baseline_pcb> processes;
+    processes.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        baseline_pcb process = {};
+        process.PID = i + 1;
+        process.size = 1 + rng() % 40;
+        process.start_time = -1;
+        process.processing_time = 50 + rng() % 450;
+        process.remaining_time = process.processing_time;
+        process.partition_number = -1;
+        process.io_freq = 5 + rng() % 45;
+        process.io_duration = 10 + rng() % 200;
+        process.state = WAITING;
+        process.io_return_time = rng() % (count / 2 + 1);
+        processes.push_back(process);
+    }
+    return processes;
+}
+
+template <typename Tick>
+bench_result measure(Tick tick, unsigned int ticks)
+{
+    int counter = open_cache_miss_counter();
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned long long checksum = 0;
+    for (unsigned int current_time = 0; current_time < ticks; current_time++)
+    {
+        checksum += tick(current_time);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    long long misses = -1;
+    if (counter >= 0)
+    {
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &misses, sizeof(misses)) != sizeof(misses))
+        {
+            misses = -1;
+        }
+        close(counter);
+    }
+
+    return {std::chrono::duration<double>(end - start).count(), misses, checksum};
+}
+
+// The scheduler tick on copied PCBs, as the simulators did before the process table
+bench_result run_aos(const std::vector<baseline_pcb> &processes, unsigned int ticks)
+{
+    std::vector<baseline_pcb> wait_queue = processes;
+    std::vector<baseline_pcb> ready_queue;
+    baseline_pcb running;
+    idle_CPU(running);
+
+    auto tick = [&](unsigned int current_time) -> unsigned long long
+    {
+        auto wait_iterator = wait_queue.begin();
+        while (wait_iterator != wait_queue.end())
+        {
+            if (wait_iterator->io_return_time <= current_time)
+            {
+                wait_iterator->state = READY;
+                ready_queue.push_back(*wait_iterator);
+                wait_iterator = wait_queue.erase(wait_iterator);
+            }
+            else
+            {
+                wait_iterator += 1;
+            }
+        }
+
+        if (running.PID == -1 && !ready_queue.empty())
+        {
+            running = ready_queue.front();
+            ready_queue.erase(ready_queue.begin());
+            running.state = RUNNING;
+            running.time_slice_time = 0;
+        }
+
+        if (running.PID != -1)
+        {
+            running.remaining_time -= 1;
+            running.time_since_io += 1;
+            running.time_slice_time += 1;
+            if (running.remaining_time == 0)
+            {
+                idle_CPU(running);
+            }
+            else if (running.time_since_io >= running.io_freq)
+            {
+                running.state = WAITING;
+                running.io_return_time = current_time + running.io_duration;
+                running.time_since_io = 0;
+                wait_queue.push_back(running);
+                idle_CPU(running);
+            }
+            else if (running.time_slice_time >= 100)
+            {
+                running.state = READY;
+                ready_queue.push_back(running);
+                idle_CPU(running);
+            }
+        }
+        return ready_queue.size() + wait_queue.size();
+    };
+
+    return measure(tick, ticks);
+}
+
+// The same tick on the structure-of-arrays process table with index queues
+bench_result run_soa(const std::vector<baseline_pcb> &processes, unsigned int ticks)
+{
+    baseline_table table;
+    for (const auto &process : processes)
+    {
+        table.remaining_time.push_back(process.remaining_time);
+        table.time_since_io.push_back(process.time_since_io);
+        table.time_slice_time.push_back(process.time_slice_time);
+        table.io_return_time.push_back(process.io_return_time);
+        table.state.push_back(process.state);
+    }
+    table.pcb = processes;
+    std::vector<uint32_t> wait_queue(processes.size());
+    for (uint32_t i = 0; i < wait_queue.size(); i++)
+    {
+        wait_queue[i] = i;
+    }
+    std::vector<uint32_t> ready_queue;
+    uint32_t running = NO_PROCESS;
+
+    auto tick = [&](unsigned int current_time) -> unsigned long long
+    {
+        auto wait_iterator = wait_queue.begin();
+        while (wait_iterator != wait_queue.end())
+        {
+            if (table.io_return_time[*wait_iterator] <= current_time)
+            {
+                table.state[*wait_iterator] = READY;
+                ready_queue.push_back(*wait_iterator);
+                wait_iterator = wait_queue.erase(wait_iterator);
+            }
+            else
+            {
+                wait_iterator += 1;
+            }
+        }
+
+        if (running == NO_PROCESS && !ready_queue.empty())
+        {
+            running = ready_queue.front();
+            ready_queue.erase(ready_queue.begin());
+            table.state[running] = RUNNING;
+            table.time_slice_time[running] = 0;
+        }
+
+        if (running != NO_PROCESS)
+        {
+            table.remaining_time[running] -= 1;
+            table.time_since_io[running] += 1;
+            table.time_slice_time[running] += 1;
+            if (table.remaining_time[running] == 0)
+            {
+                running = NO_PROCESS;
+            }
+            else if (table.time_since_io[running] >= table.pcb[running].io_freq)
+            {
+                table.state[running] = WAITING;
+                table.io_return_time[running] = current_time + table.pcb[running].io_duration;
+                table.time_since_io[running] = 0;
+                wait_queue.push_back(running);
+                running = NO_PROCESS;
+            }
+            else if (table.time_slice_time[running] >= 100)
+            {
+                table.state[running] = READY;
+                ready_queue.push_back(running);
+                running = NO_PROCESS;
+            }
+        }
+        return ready_queue.size() + wait_queue.size();
+    };
+
+    return measure(tick, ticks);
+}
+
+// The real Simulator (EP_RR, no output) for the first ticks ms of a generated trace; its checksum counts
+// the steps taken and has nothing to match in the tick variants
+bench_result run_simulator(uint32_t count, unsigned int ticks)
+{
+    workload_config workload;
+    workload.count = count;
+    workload.arrival_rate = 0;
+    std::vector<PCB> processes = generate_processes(workload);
+
+    SimConfig config;
+    config.policy = EXTERNAL_PRIORITY_RR;
+    config.record_execution = false;
+    Simulator simulator(config);
+    simulator.load(processes);
+
+    auto tick = [&](unsigned int current_time) -> unsigned long long
+    {
+        return simulator.run_until(current_time + 1, ULLONG_MAX);
+    };
+
+    return measure(tick, ticks);
+}
+
+void print_result(const char *layout, const bench_result &result, uint32_t count, unsigned int ticks)
+{
+    double scanned = (double)count * ticks;
+    std::cout << std::left << std::setw(6) << layout
+              << " time " << std::fixed << std::setprecision(3) << result.seconds << "s"
+              << "  ticks/s " << std::setprecision(1) << ticks / result.seconds
+              << "  queue entries/s " << std::setprecision(0) << scanned / result.seconds
+              << "  cache misses ";
+    if (result.cache_misses >= 0)
+    {
+        std::cout << result.cache_misses;
+    }
+    else
+    {
+        std::cout << "unavailable";
+    }
+    std::cout << "  checksum " << result.checksum << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t count = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+    unsigned int ticks = (argc > 2) ? std::stoul(argv[2]) : 200;
+
+    std::vector<baseline_pcb> processes = make_processes(count);
+    std::cout << count << " processes, " << ticks << " ticks, sizeof(baseline_pcb) = " << sizeof(baseline_pcb)
+              << " bytes (sizeof(PCB) = " << sizeof(PCB) << "), hot SoA bytes per process = "
+              << sizeof(uint32_t) * 3 + sizeof(uint16_t) + sizeof(uint8_t) << std::endl;
+
+    bench_result aos = run_aos(processes, ticks);
+    print_result("AoS", aos, count, ticks);
+    bench_result soa = run_soa(processes, ticks);
+    print_result("SoA", soa, count, ticks);
+
+    if (aos.checksum != soa.checksum)
+    {
+        std::cerr << "Error: layouts diverged" << std::endl;
+        return -1;
+    }
+
+    std::cout << "speedup " << std::setprecision(2) << aos.seconds / soa.seconds << "x" << std::endl;
+
+    bench_result simulator = run_simulator(count, ticks);
+    std::cout << std::left << std::setw(6) << "Sim"
+              << " time " << std::setprecision(3) << simulator.seconds << "s"
+              << "  ticks/s " << std::setprecision(1) << ticks / simulator.seconds
+              << "  steps " << simulator.checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,284 @@
+/**
+ * @file sim_bench.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Benchmark suite for the three schedulers on generated traces
+ *
+ * For every trace size a trace is generated with workload_generator.hpp, then:
+ *  - parse throughput is measured in-process with check_trace() in its default (reject) mode, the
+ *    same parse and check the simulators run,
+ *  - each scheduler binary is run on the trace in a scratch directory, measuring wall time,
+ *    simulated events (rows of the execution table) per second and peak RSS (from wait4()).
+ * Results are written as JSON; bench/compare_bench.py compares two result files.
+ *
+ * Usage: ./sim_bench [--bin-dir DIR] [--sizes 1000,100000,10000000] [--seed N]
+ *                    [--max-seconds N] [--work-dir DIR] [--output results.json]
+ */
+
+#include <trace_check.hpp>
+#include <workload_generator.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct run_result
+{
+    std::string scheduler;
+    unsigned long long processes;
+    unsigned long long events;
+    double seconds;
+    long peak_rss_kb;
+    bool completed; // false when the run failed or hit --max-seconds
+};
+
+struct parse_result
+{
+    unsigned long long processes;
+    unsigned long long bytes;
+    double seconds;
+};
+
+// Runs one simulator on the trace inside work_dir and waits for it, collecting its rusage
+run_result run_scheduler(const std::string &bin_dir, const std::string &scheduler, const std::string &trace,
+                         const std::string &work_dir, unsigned long long processes, unsigned int max_seconds)
+{
+    run_result result = {scheduler, processes, 0, 0, 0, false};
+    std::string binary = bin_dir + "/interrupts_" + scheduler;
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child == 0)
+    {
+        // The simulator writes its output files to the working directory and spams stdout
+        if (chdir(work_dir.c_str()) != 0)
+        {
+            _exit(127);
+        }
+        FILE *null_output = std::freopen("/dev/null", "w", stdout);
+        (void)null_output;
+        if (max_seconds > 0)
+        {
+            alarm(max_seconds); // survives exec, SIGALRM ends the run
+        }
+        execl(binary.c_str(), binary.c_str(), trace.c_str(), (char *)nullptr);
+        _exit(127);
+    }
+    if (child < 0)
+    {
+        std::cerr << "Error: fork failed" << std::endl;
+        return result;
+    }
+
+    int status = 0;
+    rusage usage;
+    wait4(child, &status, 0, &usage);
+    auto end = std::chrono::steady_clock::now();
+
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.peak_rss_kb = usage.ru_maxrss;
+    result.completed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!result.completed)
+    {
+        return result;
+    }
+
+    // Every row of the execution table except the header row is one transition
+    std::ifstream execution(work_dir + "/execution" + scheduler + ".txt");
+    std::string line;
+    unsigned long long rows = 0;
+    while (std::getline(execution, line))
+    {
+        if (!line.empty() && line[0] == '|')
+        {
+            rows += 1;
+        }
+    }
+    result.events = (rows > 0) ? rows - 1 : 0;
+    return result;
+}
+
+// Parses and checks the trace exactly like the simulators' main() does, with the default --check
+parse_result parse_trace(const std::string &trace)
+{
+    parse_result result = {0, 0, 0};
+    auto start = std::chrono::steady_clock::now();
+
+    std::ifstream input_file(trace);
+    trace_check_config check;
+    check.largest_partition = largest_partition(SimConfig());
+    std::vector<PCB> list_process = check_trace(input_file, check).processes;
+
+    auto end = std::chrono::steady_clock::now();
+    struct stat trace_stat;
+    if (stat(trace.c_str(), &trace_stat) == 0)
+    {
+        result.bytes = trace_stat.st_size;
+    }
+    result.processes = list_process.size();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+std::string current_commit()
+{
+    std::string commit;
+    FILE *git = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+    if (git != nullptr)
+    {
+        char buffer[64];
+        if (std::fgets(buffer, sizeof(buffer), git) != nullptr)
+        {
+            commit = buffer;
+            commit.erase(commit.find_last_not_of("\r\n") + 1);
+        }
+        pclose(git);
+    }
+    return commit.empty() ? "unknown" : commit;
+}
+
+std::string to_json(const std::string &commit, const std::vector<parse_result> &parses, const std::vector<run_result> &runs)
+{
+    std::stringstream buffer;
+    buffer << std::fixed << std::setprecision(6);
+    buffer << "{\n  \"commit\": \"" << commit << "\",\n  \"timestamp\": " << std::time(nullptr) << ",\n";
+
+    buffer << "  \"parse\": [\n";
+    for (std::size_t i = 0; i < parses.size(); i++)
+    {
+        const auto &parse = parses[i];
+        double seconds = std::max(parse.seconds, 1e-9);
+        buffer << "    {\"processes\": " << parse.processes
+               << ", \"bytes\": " << parse.bytes
+               << ", \"seconds\": " << parse.seconds
+               << ", \"lines_per_second\": " << parse.processes / seconds
+               << ", \"mb_per_second\": " << parse.bytes / seconds / 1e6 << "}"
+               << ((i + 1 < parses.size()) ? ",\n" : "\n");
+    }
+    buffer << "  ],\n";
+
+    buffer << "  \"runs\": [\n";
+    for (std::size_t i = 0; i < runs.size(); i++)
+    {
+        const auto &run = runs[i];
+        double seconds = std::max(run.seconds, 1e-9);
+        buffer << "    {\"scheduler\": \"" << run.scheduler << "\""
+               << ", \"processes\": " << run.processes
+               << ", \"completed\": " << (run.completed ? "true" : "false")
+               << ", \"events\": " << run.events
+               << ", \"seconds\": " << run.seconds
+               << ", \"events_per_second\": " << run.events / seconds
+               << ", \"peak_rss_kb\": " << run.peak_rss_kb << "}"
+               << ((i + 1 < runs.size()) ? ",\n" : "\n");
+    }
+    buffer << "  ]\n}\n";
+
+    return buffer.str();
+}
+
+int main(int argc, char **argv)
+{
+    std::string bin_dir = ".";
+    std::string work_dir = "sim_bench_work";
+    std::string output_name = "bench_results.json";
+    std::vector<unsigned long long> sizes = {1000, 100000, 10000000};
+    unsigned long long seed = 4001;
+    unsigned int max_seconds = 0;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--bin-dir")
+            bin_dir = value;
+        else if (option == "--work-dir")
+            work_dir = value;
+        else if (option == "--output")
+            output_name = value;
+        else if (option == "--seed")
+            seed = std::stoull(value);
+        else if (option == "--max-seconds")
+            max_seconds = std::stoul(value);
+        else if (option == "--sizes")
+        {
+            sizes.clear();
+            for (const auto &size : split_delim(value, ","))
+            {
+                sizes.push_back(std::stoull(size));
+            }
+        }
+        else
+        {
+            std::cerr << "Error: unknown option " << option << std::endl;
+            return -1;
+        }
+    }
+
+    mkdir(work_dir.c_str(), 0755);
+
+    // The simulators run from inside work_dir, so the binaries need an absolute path
+    char *absolute_bin_dir = realpath(bin_dir.c_str(), nullptr);
+    if (absolute_bin_dir == nullptr)
+    {
+        std::cerr << "Error: no such directory " << bin_dir << std::endl;
+        return -1;
+    }
+    bin_dir = absolute_bin_dir;
+    std::free(absolute_bin_dir);
+
+    std::vector<parse_result> parses;
+    std::vector<run_result> runs;
+    const std::vector<std::string> schedulers = {"RR", "EP", "EP_RR"};
+
+    for (unsigned long long size : sizes)
+    {
+        workload_config config;
+        config.count = size;
+        config.seed = seed;
+
+        std::string trace = work_dir + "/trace_" + std::to_string(size) + ".txt";
+        FILE *trace_file = std::fopen(trace.c_str(), "w");
+        if (trace_file == nullptr || !write_workload(config, trace_file) || std::fclose(trace_file) != 0)
+        {
+            std::cerr << "Error: Unable to write trace " << trace << std::endl;
+            return -1;
+        }
+
+        parse_result parse = parse_trace(trace);
+        parses.push_back(parse);
+        std::cout << "parse   " << std::setw(9) << size << " processes  "
+                  << std::fixed << std::setprecision(1) << parse.bytes / std::max(parse.seconds, 1e-9) / 1e6 << " MB/s" << std::endl;
+
+        char *absolute_trace = realpath(trace.c_str(), nullptr);
+        for (const auto &scheduler : schedulers)
+        {
+            run_result run = run_scheduler(bin_dir, scheduler, absolute_trace, work_dir, size, max_seconds);
+            runs.push_back(run);
+            std::cout << std::left << std::setw(8) << scheduler << std::right << std::setw(9) << size << " processes  ";
+            if (run.completed)
+            {
+                std::cout << std::setprecision(0) << run.events / std::max(run.seconds, 1e-9) << " events/s  "
+                          << run.peak_rss_kb << " KB peak RSS" << std::endl;
+            }
+            else
+            {
+                std::cout << "did not complete (" << std::setprecision(1) << run.seconds << "s)" << std::endl;
+            }
+        }
+        std::free(absolute_trace);
+        std::remove(trace.c_str());
+    }
+
+    std::ofstream output(output_name);
+    output << to_json(current_commit(), parses, runs);
+    if (!output)
+    {
+        std::cerr << "Error: Unable to write " << output_name << std::endl;
+        return -1;
+    }
+    std::cout << "Results written to " << output_name << std::endl;
+
+    return 0;
+}
@@ -1,9 +1,5 @@
-if [ ! -d "bin" ]; then
-    mkdir bin
-else
-	rm bin/*
-fi
+# Optimized build of the schedulers, tools and benchmarks into build/bin
+# (pass Debug as the first argument for an -O0 -g build)
+BUILD_TYPE=${1:-Release}
 
-g++ -g -O0 -I . -o bin/interrupts_EP interrupts_student1_student2_EP.cpp
-g++ -g -O0 -I . -o bin/interrupts_RR interrupts_student1_student2_RR.cpp
-g++ -g -O0 -I . -o bin/interrupts_EP_RR interrupts_student1_student2_EP_RR.cpp
\ No newline at end of file
+cmake -S . -B build -DCMAKE_BUILD_TYPE=$BUILD_TYPE && cmake --build build -j
@@ -0,0 +1,206 @@
+/**
+ * @file chrome_trace.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Streams a run as Chrome Trace Event JSON
+ *
+ */
+
+#include <chrome_trace.hpp>
+
+#include <charconv>
+
+// Trace "processes" that group the tracks
+static const int CPU_TRACK = 1;
+static const int PROCESS_TRACKS = 2;
+static const int MEMORY_TRACKS = 3;
+
+chrome_trace_writer::chrome_trace_writer(const std::string &path)
+    : first_event(true), closed(false), ready(0), waiting(0)
+{
+    output = (path == "-") ? stdout : std::fopen(path.c_str(), "w");
+    buffer.reserve(1 << 20);
+
+    buffer += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    begin_event();
+    buffer += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}}";
+    begin_event();
+    buffer += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"Processes\"}}";
+    begin_event();
+    buffer += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":3,\"args\":{\"name\":\"Memory\"}}";
+    write_track_name(CPU_TRACK, 0, "CPU");
+}
+
+chrome_trace_writer::~chrome_trace_writer()
+{
+    if (output == nullptr)
+    {
+        return;
+    }
+    if (!closed)
+    {
+        buffer += "\n]}\n";
+    }
+    flush();
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+}
+
+void chrome_trace_writer::on_transition(const sim_transition &transition)
+{
+    if (transition.process >= named_process.size())
+    {
+        named_process.resize(transition.process + 1, false);
+    }
+    if (!named_process[transition.process])
+    {
+        named_process[transition.process] = true;
+        write_track_name(PROCESS_TRACKS, transition.PID, "PID " + std::to_string(transition.PID));
+    }
+
+    const char *state_names[] = {"NEW", "READY", "RUNNING", "WAITING", "TERMINATED", "NOT_ASSIGNED",
+                                 "SUSPENDED_READY", "SUSPENDED_WAITING"};
+    write_span(state_names[transition.old_state], PROCESS_TRACKS, transition.PID, transition.since, transition.time, transition.PID);
+    if (transition.old_state == RUNNING)
+    {
+        write_span(("PID " + std::to_string(transition.PID)).c_str(), CPU_TRACK, 0, transition.since, transition.time, transition.PID);
+    }
+
+    // queue depth and I/O in flight, only when they change
+    if (transition.old_state == READY || transition.new_state == READY)
+    {
+        ready = (transition.new_state == READY) ? ready + 1 : ready - 1;
+        write_counter("ready queue", transition.time, ready);
+    }
+    if (transition.old_state == WAITING || transition.new_state == WAITING)
+    {
+        waiting = (transition.new_state == WAITING) ? waiting + 1 : waiting - 1;
+        write_counter("I/O in flight", transition.time, waiting);
+    }
+
+    if (buffer.size() >= (1 << 20) - 4096)
+    {
+        flush();
+    }
+}
+
+void chrome_trace_writer::on_partition(unsigned int time, const memory_partition &partition)
+{
+    if (partition.partition_number >= partition_since.size())
+    {
+        partition_since.resize(partition.partition_number + 1, 0);
+        partition_occupant.resize(partition.partition_number + 1, -1);
+        named_partition.resize(partition.partition_number + 1, false);
+    }
+    if (!named_partition[partition.partition_number])
+    {
+        named_partition[partition.partition_number] = true;
+        write_track_name(MEMORY_TRACKS, partition.partition_number,
+                         "Partition " + std::to_string(partition.partition_number) + " (" + std::to_string(partition.size) + "MB)");
+    }
+
+    if (partition.occupied != -1)
+    {
+        partition_since[partition.partition_number] = time;
+        partition_occupant[partition.partition_number] = partition.occupied;
+        return;
+    }
+    int PID = partition_occupant[partition.partition_number];
+    write_span(("PID " + std::to_string(PID)).c_str(), MEMORY_TRACKS, partition.partition_number,
+               partition_since[partition.partition_number], time, PID);
+}
+
+void chrome_trace_writer::on_finish(const SimResult &result)
+{
+    buffer += "\n]}\n";
+    closed = true;
+    flush();
+}
+
+void chrome_trace_writer::begin_event()
+{
+    if (!first_event)
+    {
+        buffer += ",\n";
+    }
+    first_event = false;
+}
+
+// Complete event for [start, end) in simulated ms; zero-length spans (e.g. an immediate admission) are
+// left out
+void chrome_trace_writer::write_span(const char *name, int pid, long long tid, unsigned int start, unsigned int end, int PID)
+{
+    if (end <= start)
+    {
+        return;
+    }
+    begin_event();
+    buffer += "{\"name\":\"";
+    buffer += name;
+    buffer += "\",\"ph\":\"X\",\"ts\":";
+    append_number(start * 1000LL);
+    buffer += ",\"dur\":";
+    append_number((end - start) * 1000LL);
+    buffer += ",\"pid\":";
+    append_number(pid);
+    buffer += ",\"tid\":";
+    append_number(tid);
+    if (PID != -1)
+    {
+        buffer += ",\"args\":{\"PID\":";
+        append_number(PID);
+        buffer += '}';
+    }
+    buffer += '}';
+}
+
+void chrome_trace_writer::write_counter(const char *name, unsigned int time, unsigned int value)
+{
+    begin_event();
+    buffer += "{\"name\":\"";
+    buffer += name;
+    buffer += "\",\"ph\":\"C\",\"ts\":";
+    append_number(time * 1000LL);
+    buffer += ",\"pid\":1,\"args\":{\"count\":";
+    append_number(value);
+    buffer += "}}";
+}
+
+void chrome_trace_writer::write_track_name(int pid, long long tid, const std::string &name)
+{
+    begin_event();
+    buffer += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":";
+    append_number(pid);
+    buffer += ",\"tid\":";
+    append_number(tid);
+    buffer += ",\"args\":{\"name\":\"";
+    buffer += name;
+    buffer += "\"}}";
+
+    // keep the tracks in PID / partition order in the viewer
+    begin_event();
+    buffer += "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":";
+    append_number(pid);
+    buffer += ",\"tid\":";
+    append_number(tid);
+    buffer += ",\"args\":{\"sort_index\":";
+    append_number(tid);
+    buffer += "}}";
+}
+
+void chrome_trace_writer::append_number(long long value)
+{
+    char digits[24];
+    char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+}
+
+void chrome_trace_writer::flush()
+{
+    if (output != nullptr && !buffer.empty())
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), output);
+    }
+    buffer.clear();
+}
@@ -0,0 +1,56 @@
+/**
+ * @file chrome_trace.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Streams a run as Chrome Trace Event JSON (chrome://tracing, ui.perfetto.dev)
+ *
+ * chrome_trace_writer is a SimObserver. Every finished span is written as a complete ("X") event as
+ * soon as it ends, through a 1MB buffer, so a trace of any length is written in constant memory:
+ *  - "CPU": which process held the CPU, plus counters for the ready queue depth and I/Os in flight,
+ *  - "Processes": one track per PID with its NEW (waiting for memory), READY, RUNNING and WAITING
+ *    spans,
+ *  - "Memory": one track per partition with the PID that occupied it.
+ * One simulated ms is 1000 trace microseconds, so the viewer's ms are the simulator's ms.
+ */
+
+#ifndef CHROME_TRACE_HPP_
+#define CHROME_TRACE_HPP_
+
+#include <simulator.hpp>
+
+#include <cstdio>
+
+class chrome_trace_writer : public SimObserver
+{
+public:
+    // path "-" writes to stdout
+    explicit chrome_trace_writer(const std::string &path);
+    ~chrome_trace_writer();
+
+    bool is_open() const { return output != nullptr; }
+
+    void on_transition(const sim_transition &transition) override;
+    void on_partition(unsigned int time, const memory_partition &partition) override;
+    void on_finish(const SimResult &result) override;
+
+private:
+    void begin_event();
+    void write_span(const char *name, int pid, long long tid, unsigned int start, unsigned int end, int PID);
+    void write_counter(const char *name, unsigned int time, unsigned int value);
+    void write_track_name(int pid, long long tid, const std::string &name);
+    void append_number(long long value);
+    void flush();
+
+    FILE *output;
+    std::string buffer;
+    bool first_event;
+    bool closed;
+
+    std::vector<bool> named_process;       // thread_name written for the process (by table index)
+    std::vector<unsigned int> partition_since; // time each partition (by partition_number) was taken
+    std::vector<int> partition_occupant;       // and by whom
+    std::vector<bool> named_partition;
+    unsigned int ready;
+    unsigned int waiting;
+};
+
+#endif
@@ -0,0 +1,244 @@
+/**
+ * @file energy.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief CPU frequency scaling (P-states), idle states (C-states) and the energy of a run
+ *
+ */
+
+#include <energy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+bool parse_governor(const std::string &name, dvfs_governor &governor)
+{
+    if (name == "performance")
+        governor = GOVERNOR_PERFORMANCE;
+    else if (name == "powersave")
+        governor = GOVERNOR_POWERSAVE;
+    else if (name == "queue")
+        governor = GOVERNOR_QUEUE;
+    else if (name == "energy")
+        governor = GOVERNOR_ENERGY;
+    else
+        return false;
+    return true;
+}
+
+// Splits "a:b:c,d:e:f" into groups of exactly fields numbers, each finite and 0 or more
+static bool parse_groups(const std::string &text, std::size_t fields, std::vector<std::vector<double>> &groups)
+{
+    groups.clear();
+    std::size_t start = 0;
+    while (start <= text.size())
+    {
+        std::size_t comma = std::min(text.find(',', start), text.size());
+        std::vector<double> group;
+        const char *cursor = text.c_str() + start;
+        const char *end = text.c_str() + comma;
+        while (cursor < end)
+        {
+            char *stop = nullptr;
+            group.push_back(std::strtod(cursor, &stop));
+            if (stop == cursor || (stop < end && *stop != ':') || !std::isfinite(group.back()) || group.back() < 0)
+            {
+                return false;
+            }
+            cursor = (stop < end) ? stop + 1 : stop;
+        }
+        if (group.size() != fields)
+        {
+            return false;
+        }
+        groups.push_back(group);
+        start = comma + 1;
+    }
+    return !groups.empty();
+}
+
+// Whether a parsed value can be cast to a uint32_t as it is
+static bool is_whole(double value)
+{
+    return value == std::floor(value) && value <= UINT32_MAX;
+}
+
+bool parse_p_states(const std::string &text, std::vector<p_state> &states)
+{
+    std::vector<std::vector<double>> groups;
+    if (!parse_groups(text, 2, groups))
+    {
+        return false;
+    }
+    for (const auto &group : groups)
+    {
+        if (!is_whole(group[0]))
+        {
+            return false;
+        }
+    }
+    states.clear();
+    for (const auto &group : groups)
+    {
+        states.push_back({(uint32_t)group[0], group[1]});
+    }
+    return true;
+}
+
+bool parse_c_states(const std::string &text, std::vector<c_state> &states)
+{
+    std::vector<std::vector<double>> groups;
+    if (!parse_groups(text, 3, groups))
+    {
+        return false;
+    }
+    for (const auto &group : groups)
+    {
+        if (!is_whole(group[1]) || !is_whole(group[2]))
+        {
+            return false;
+        }
+    }
+    states.clear();
+    for (const auto &group : groups)
+    {
+        states.push_back({group[0], (uint32_t)group[1], (uint32_t)group[2]});
+    }
+    return true;
+}
+
+bool check_dvfs_config(const dvfs_config &config, std::string &error)
+{
+    const auto &p_states = config.p_states;
+    const auto &c_states = config.c_states;
+    if (p_states.empty() || p_states[0].speed != 1000)
+    {
+        error = "the first P-state must run at speed 1000";
+        return false;
+    }
+    for (std::size_t i = 0; i < p_states.size(); i++)
+    {
+        if (p_states[i].power < 0 || (i > 0 && (p_states[i].speed == 0 || p_states[i].speed >= p_states[i - 1].speed)))
+        {
+            error = "P-state speeds must fall from 1000 to above 0, with powers of 0W or more";
+            return false;
+        }
+    }
+    if (c_states.empty() || c_states[0].entry_after != 0)
+    {
+        error = "the first C-state must be entered after 0ms";
+        return false;
+    }
+    for (std::size_t i = 0; i < c_states.size(); i++)
+    {
+        if (c_states[i].power < 0 || (i > 0 && c_states[i].entry_after <= c_states[i - 1].entry_after))
+        {
+            error = "C-states must be entered after more and more ms, with powers of 0W or more";
+            return false;
+        }
+    }
+    if (config.interval == 0)
+    {
+        error = "the governor interval must be at least 1ms";
+        return false;
+    }
+    return true;
+}
+
+uint32_t select_p_state(const dvfs_config &config, uint32_t current, std::size_t ready)
+{
+    // The fastest P-state within the budget, the slowest one when none is
+    uint32_t slowest = config.p_states.size() - 1;
+    uint32_t fastest = 0;
+    while (config.power_budget > 0 && fastest < slowest && config.p_states[fastest].power > config.power_budget)
+    {
+        fastest += 1;
+    }
+
+    switch (config.governor)
+    {
+    case GOVERNOR_PERFORMANCE:
+        return fastest;
+    case GOVERNOR_POWERSAVE:
+        return slowest;
+    case GOVERNOR_QUEUE:
+        if (ready >= config.up_depth)
+            return fastest;
+        if (ready <= config.down_depth)
+            return std::min(current + 1, slowest);
+        return std::max(current, fastest);
+    case GOVERNOR_ENERGY:
+    {
+        if (ready >= config.up_depth)
+        {
+            return fastest;
+        }
+        uint32_t best = fastest;
+        double idle_power = config.c_states[0].power;
+        for (uint32_t state = fastest; state <= slowest; state++)
+        {
+            const p_state &p = config.p_states[state];
+            const p_state &b = config.p_states[best];
+            if ((p.power - idle_power) / p.speed < (b.power - idle_power) / b.speed)
+            {
+                best = state;
+            }
+        }
+        return best;
+    }
+    default:
+        return 0;
+    }
+}
+
+uint32_t charge_idle(const dvfs_config &config, unsigned int idle, energy_stats &stats)
+{
+    uint32_t reached = 0;
+    for (uint32_t state = 0; state < config.c_states.size(); state++)
+    {
+        unsigned int entry = config.c_states[state].entry_after;
+        if (idle <= entry && state > 0)
+        {
+            break;
+        }
+        unsigned int leave = (state + 1 < config.c_states.size()) ? config.c_states[state + 1].entry_after : idle;
+        stats.idle_ms[state] += std::min(idle, leave) - entry;
+        reached = state;
+    }
+    return reached;
+}
+
+std::string print_energy(const energy_stats &stats, const dvfs_config &config, unsigned int end_time,
+                         std::size_t processes, double mean_turnaround)
+{
+    std::string report;
+    char line[256];
+    double seconds = end_time / 1000.0;
+    std::snprintf(line, sizeof(line), "Energy (%s governor): %.3f J over %ums, %.3f W on average", governor_name(config.governor),
+                  stats.energy / 1000, end_time, (end_time > 0) ? stats.energy / end_time : 0.0);
+    report += line;
+    std::snprintf(line, sizeof(line), "; %.3f processes/s, mean turnaround %.1fms, %.3f J per process\n",
+                  (seconds > 0) ? processes / seconds : 0.0, mean_turnaround, (processes > 0) ? stats.energy / 1000 / processes : 0.0);
+    report += line;
+
+    report += "  P-states (busy ms):";
+    for (std::size_t state = 0; state < config.p_states.size(); state++)
+    {
+        std::snprintf(line, sizeof(line), " %u/1000 %gW %llu%s", config.p_states[state].speed, config.p_states[state].power,
+                      stats.busy_ms[state], (state + 1 < config.p_states.size()) ? "," : "");
+        report += line;
+    }
+    std::snprintf(line, sizeof(line), "; %llu switches\n", stats.switches);
+    report += line;
+
+    report += "  C-states (idle ms/wake-ups):";
+    for (std::size_t state = 0; state < config.c_states.size(); state++)
+    {
+        std::snprintf(line, sizeof(line), " C%zu %gW %llu/%llu%s", state, config.c_states[state].power, stats.idle_ms[state],
+                      stats.wakeups[state], (state + 1 < config.c_states.size()) ? "," : "");
+        report += line;
+    }
+    report += "\n";
+    return report;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file energy.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief CPU frequency scaling (P-states), idle states (C-states) and the energy of a run
+ *
+ * With a governor set in SimConfig::dvfs the CPU runs at one of a table of P-states, fastest first,
+ * each with a speed (permille of the fastest) and a power draw. A ms at speed s does s/1000 ms of work,
+ * kept as a credit in µs of full-speed work so that, say, 600‰ finishes a ms of a burst on 3 ms out
+ * of 5. A process's CPU time and I/O frequency are in ms of work, so its bursts stretch as the CPU
+ * slows down; the quantum stays in ms of wall time. A P-state change stalls the CPU for
+ * switch_latency µs. The governor picks the P-state every interval ms of busy CPU and on every
+ * wake-up:
+ *  - performance: the fastest one
+ *  - powersave:   the slowest one
+ *  - queue:       the fastest once up_depth processes are ready, one step slower each time down_depth
+ *                 or fewer are, otherwise the same
+ *  - energy:      the energy-aware policy: the fastest once up_depth processes are ready, otherwise
+ *                 the P-state with the least energy per ms of work above the idle draw,
+ *                 (power - shallowest idle power) / speed, since a faster state gets to idle sooner
+ *                 but the idle power is paid either way
+ * No governor picks a P-state drawing more than power_budget. An idle CPU sinks through the C-states,
+ * each entered after entry_after ms of idle, and waking it from one delays the dispatched process by
+ * exit_latency µs. Idle periods are charged when the CPU wakes up (or at the end), not per ms, and
+ * the busy ms are the only ones that pay for the scaling.
+ */
+
+#ifndef ENERGY_HPP_
+#define ENERGY_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct p_state
+{
+    uint32_t speed; // permille of the fastest P-state
+    double power;   // W while busy
+};
+
+struct c_state
+{
+    double power;          // W
+    uint32_t entry_after;  // ms of idle before the CPU gets there (0 for the first one)
+    uint32_t exit_latency; // µs to wake up from it
+};
+
+enum dvfs_governor
+{
+    GOVERNOR_OFF, // no frequency scaling nor energy accounting
+    GOVERNOR_PERFORMANCE,
+    GOVERNOR_POWERSAVE,
+    GOVERNOR_QUEUE,
+    GOVERNOR_ENERGY
+};
+
+inline const char *governor_name(dvfs_governor governor)
+{
+    const char *names[] = {"off", "performance", "powersave", "queue", "energy"};
+    return names[governor];
+}
+
+// A mobile-class table: power grows about with the cube of the speed
+inline std::vector<p_state> default_p_states()
+{
+    return {{1000, 12.0}, {800, 7.0}, {600, 4.0}, {400, 2.2}};
+}
+
+inline std::vector<c_state> default_c_states()
+{
+    return {{2.0, 0, 0}, {0.6, 5, 100}, {0.1, 50, 400}};
+}
+
+struct dvfs_config
+{
+    dvfs_governor governor = GOVERNOR_OFF;
+    std::vector<p_state> p_states = default_p_states();
+    std::vector<c_state> c_states = default_c_states();
+    unsigned int switch_latency = 50; // µs the CPU stalls on a P-state change
+    unsigned int interval = 10;       // ms of busy CPU between governor decisions
+    unsigned int up_depth = 2;        // ready processes that send queue and energy to the fastest P-state
+    unsigned int down_depth = 0;      // queue: ready processes at or below which it slows down a step
+    double power_budget = 0;          // W, no P-state above it is used, 0 = no budget
+};
+
+struct energy_stats
+{
+    std::vector<unsigned long long> busy_ms; // per P-state
+    std::vector<unsigned long long> idle_ms; // per C-state
+    std::vector<unsigned long long> wakeups; // per C-state woken up from
+    unsigned long long switches = 0;         // P-state changes
+    double energy = 0;                       // mJ, filled in at the end of the run
+};
+
+// What the Simulator keeps between ms while scaling
+struct dvfs_state
+{
+    uint32_t p_state = 0;
+    int64_t work_credit = 0;    // µs of full-speed work not yet a whole ms, negative after a stall
+    uint32_t busy_until = 0;    // end of the last busy ms
+    uint32_t next_decision = 0; // time of the next governor decision
+    energy_stats stats;
+};
+
+// "performance", "powersave", "queue" or "energy"; returns false for anything else
+bool parse_governor(const std::string &name, dvfs_governor &governor);
+
+// "SPEED:WATTS,..." fastest first, e.g. "1000:12,600:4", and "WATTS:AFTER_MS:EXIT_US,...", e.g.
+// "2:0:0,0.1:50:400"; return false on a malformed list, a negative or non-finite value, or a
+// fraction where the field is a whole number (speeds, ms and µs)
+bool parse_p_states(const std::string &text, std::vector<p_state> &states);
+bool parse_c_states(const std::string &text, std::vector<c_state> &states);
+
+// Whether the tables make sense (speeds falling from 1000, C-states deepening from 0 ms), error says why
+bool check_dvfs_config(const dvfs_config &config, std::string &error);
+
+// The P-state the governor wants with ready processes ready, running at current
+uint32_t select_p_state(const dvfs_config &config, uint32_t current, std::size_t ready);
+
+// Charges an idle period of idle ms to the C-states, returns the one the CPU ended up in
+uint32_t charge_idle(const dvfs_config &config, unsigned int idle, energy_stats &stats);
+
+// Energy, average power, throughput and mean turnaround of a run of processes that ended at end_time
+std::string print_energy(const energy_stats &stats, const dvfs_config &config, unsigned int end_time,
+                         std::size_t processes, double mean_turnaround);
+
+#endif
@@ -1,7 +1,7 @@
 /**
  * @file interrupts.hpp
  * @author Aydan Eng, Eric Cui
- * @brief template main.cpp file for Assignment 3 Part 1 of SYSC4001 amd includes Assignment 1 and 2 code
+ * @brief types and helper functions shared by the simulator library and tools, includes Assignment 1 and 2 code
  *
  */
 
@@ -18,6 +18,11 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <cstdint>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
 
 // An enumeration of states to make assignment easier
 enum states
@@ -27,9 +32,14 @@ enum states
     RUNNING,
     WAITING,
     TERMINATED,
-    NOT_ASSIGNED
+    NOT_ASSIGNED,
+    SUSPENDED_READY,  // swapped out to the backing store (see SimConfig::swapping), ready once back in memory
+    SUSPENDED_WAITING // swapped out while its I/O was in flight
 };
-std::ostream &operator<<(std::ostream &os, const enum states &s)
+
+// Number of states values, for the per-state counters
+inline const int STATE_COUNT = 8;
+inline std::ostream &operator<<(std::ostream &os, const enum states &s)
 { // Overloading the << operator to make printing of the enum easier
 
     std::string state_names[] = {
@@ -38,7 +48,9 @@ std::ostream &operator<<(std::ostream &os, const enum states &s)
         "RUNNING",
         "WAITING",
         "TERMINATED",
-        "NOT_ASSIGNED"};
+        "NOT_ASSIGNED",
+        "SUSPENDED_READY",
+        "SUSPENDED_WAITING"};
     return (os << state_names[s]);
 }
 
@@ -47,7 +59,10 @@ struct memory_partition
     unsigned int partition_number;
     unsigned int size;
     int occupied;
-} memory_partitions[] = {
+};
+
+// Default partition table, the simulator works on its own copy (see SimConfig::partitions)
+inline const memory_partition memory_partitions[] = {
     {1, 40, -1},
     {2, 25, -1},
     {3, 15, -1},
@@ -55,6 +70,11 @@ struct memory_partition
     {5, 8, -1},
     {6, 2, -1}};
 
+inline std::vector<memory_partition> default_partitions()
+{
+    return std::vector<memory_partition>(std::begin(memory_partitions), std::end(memory_partitions));
+}
+
 struct PCB
 {
     int PID;
@@ -71,11 +91,31 @@ struct PCB
     unsigned int time_slice_time;
     unsigned int io_return_time;
     unsigned int time_since_io;
+
+    int priority;             // lower value = higher priority, defaults to the PID when the input has no priority column
+    unsigned int ready_since; // time the process last entered READY, used for lazy aging
+
+    // Starvation/fairness counters, kept up to date by change_state() on every transition
+    unsigned int state_entered;      // time of the last transition
+    unsigned int time_in_state[STATE_COUNT]; // ms spent in each states value (NEW = waiting for memory)
+    unsigned int preemptions;        // RUNNING -> READY transitions
+    unsigned int io_waits;           // RUNNING -> WAITING transitions
+    unsigned int swap_outs;          // times suspended to the backing store
+    unsigned int longest_ready_wait; // longest single stay in READY
+
+    // I/O profile (see burst_run): the process's runs are bursts[burst_first, burst_end), burst_cursor
+    // is the current one and burst_repeats how many of its bursts were issued. io_freq/io_duration
+    // always hold the current burst. burst_first == burst_end for the plain periodic I/O.
+    uint32_t burst_first;
+    uint32_t burst_end;
+    uint32_t burst_cursor;
+    uint32_t burst_repeats;
+    uint32_t bursts_issued; // I/O bursts issued so far, numbers the exponential draws
 };
 
 //-------------------------------CODE FROM ASSINGMENT 1 AND ASSIGNMENT 2------------------------------
 
-const std::vector<std::string> VECTOR_TABLE = {
+inline const std::vector<std::string> VECTOR_TABLE = {
     "0X01E3",
     "0X029C",
     "0X0695",
@@ -85,77 +125,80 @@ const std::vector<std::string> VECTOR_TABLE = {
     // don't need rest of the vectors for this assignment
 };
 
-// Boilerplate function for interrupts from assignment 1
-std::pair<std::string, int> intr_boilerplate(int current_time, int intr_num, int context_save_time)
+// Boilerplate function for interrupts from assignment 1. The simulation charges context_save_time and
+// nothing else (see interrupts.md); with detailed set the steps are also written out, each with what it
+// costs a real system (real_save_time for the context save), in the "time, duration, activity" format.
+inline std::pair<std::string, int> intr_boilerplate(int current_time, int intr_num, int context_save_time,
+                                                    bool detailed = false, int real_save_time = 0)
 {
     std::string execution = "";
-
-    // execution += std::to_string(current_time) + ", " + std::to_string(1) + ", switch to kernel mode\n";
-    // current_time++;
-
-    // execution += std::to_string(current_time) + ", " + std::to_string(context_save_time) + ", context saved\n";
-    // current_time += context_save_time;
-
-    // char vector_address_c[10];
-    // sprintf(vector_address_c, "0x%04X", (intr_num * 2));
-    // std::string vector_address(vector_address_c);
-    // std::string isr_address = (intr_num < (int)VECTOR_TABLE.size()) ? VECTOR_TABLE[intr_num] : "0X0000";
-
-    // execution += std::to_string(current_time) + ", " + std::to_string(1) + ", find vector " + std::to_string(intr_num) + " in memory position " + vector_address + "\n";
-    // current_time++;
-
-    // execution += std::to_string(current_time) + ", " + std::to_string(1) + ", load address " + isr_address + " into the PC\n";
-    // current_time++;
+    if (detailed)
+    {
+        char vector_address[10];
+        std::snprintf(vector_address, sizeof(vector_address), "0x%04X", (intr_num * 2));
+        std::string isr_address = (intr_num < (int)VECTOR_TABLE.size()) ? VECTOR_TABLE[intr_num] : "0X0000";
+        std::string time = std::to_string(current_time);
+
+        execution += time + ", 1, switch to kernel mode\n";
+        execution += time + ", " + std::to_string(real_save_time) + ", context saved\n";
+        execution += time + ", 1, find vector " + std::to_string(intr_num) + " in memory position " + vector_address + "\n";
+        execution += time + ", 1, load address " + isr_address + " into the PC\n";
+    }
+    current_time += context_save_time;
 
     return std::make_pair(execution, current_time);
 }
 
+// Appends the ISR steps after the boilerplate, see intr_boilerplate()
+inline void append_isr_steps(std::string &execution, int current_time, std::initializer_list<std::pair<int, const char *>> steps)
+{
+    for (const auto &[duration, activity] : steps)
+    {
+        execution += std::to_string(current_time) + ", " + std::to_string(duration) + ", " + activity + "\n";
+    }
+}
+
 // CONTEXT SWIITCH
-std::pair<std::string, int> context_switch(int current_time)
+// Context save time is 0 to match the test cases (10 in a real system), see interrupts.md
+inline std::pair<std::string, int> context_switch(int current_time, bool detailed = false)
 {
-    auto [execution, time] = intr_boilerplate(current_time, 2, 0); // Change context save time to 10 to mimic real system with overhead and uncomment lines, only switched to 0 to match test cases, see interrupts.md
-    // execution += std::to_string(time) + ", 1, IRET\n";
-    // time += 1;
+    auto [execution, time] = intr_boilerplate(current_time, 2, 0, detailed, 10);
+    if (detailed)
+    {
+        append_isr_steps(execution, time, {{1, "IRET"}});
+    }
     return std::make_pair(execution, time);
 }
 
 // Note: No longer random IO delays (was random in A2) to properly compare RR, EP and EP_RR
 
 // SYSCCALL
-std::pair<std::string, int> system_call(int current_time)
-{
-    auto [execution, time] = intr_boilerplate(current_time, 3, 0); // Change context save time to 4 to mimic real system with overhead and uncomment lines, only switched to 0 to match test cases, see interrupts.md
-    // execution += std::to_string(time) + ", 1, obtain ISR address\n";
-    // time += 1;
-    // execution += std::to_string(time) + ", 2, Call device driver\n";
-    // time += 2;
-    // execution += std::to_string(time) + ", 1, Perform device check\n";
-    // time += 1;
-    // execution += std::to_string(time) + ", 1, Send device instruction\n";
-    // time += 1;
-    // execution += std::to_string(time) + ", 1, IRET\n";
-    // time += 1;
+// Context save time is 0 to match the test cases (4 in a real system), see interrupts.md
+inline std::pair<std::string, int> system_call(int current_time, bool detailed = false)
+{
+    auto [execution, time] = intr_boilerplate(current_time, 3, 0, detailed, 4);
+    if (detailed)
+    {
+        append_isr_steps(execution, time, {{1, "obtain ISR address"}, {2, "Call device driver"}, {1, "Perform device check"}, {1, "Send device instruction"}, {1, "IRET"}});
+    }
     return std::make_pair(execution, time);
 }
 
 // END_IO
-std::pair<std::string, int> end_io(int current_time)
-{
-    auto [execution, time] = intr_boilerplate(current_time, 4, 0); // Change context save time to 4 to mimic real system with overhead and uncomment lines, only switched to 0 to match test cases, see interrupts.md
-    // execution += std::to_string(time) + ", 2, store information in memory\n";
-    // time += 2;
-    // execution += std::to_string(time) + ", 1, reset the io operation\n";
-    // time += 1;
-    // execution += std::to_string(time) + ", 1, Send standby instruction\n";
-    // time += 1;
-    // execution += std::to_string(time) + ", 1, IRET\n";
-    // time += 1;
+// Context save time is 0 to match the test cases (4 in a real system), see interrupts.md
+inline std::pair<std::string, int> end_io(int current_time, bool detailed = false)
+{
+    auto [execution, time] = intr_boilerplate(current_time, 4, 0, detailed, 4);
+    if (detailed)
+    {
+        append_isr_steps(execution, time, {{1, "obtain ISR address"}, {2, "store information in memory"}, {1, "reset the io operation"}, {1, "Send standby instruction"}, {1, "IRET"}});
+    }
     return std::make_pair(execution, time);
 }
 
 //------------------------------------HELPER FUNCTIONS FOR THE SIMULATOR------------------------------
 // Following function was taken from stackoverflow; helper function for splitting strings
-std::vector<std::string> split_delim(std::string input, std::string delim)
+inline std::vector<std::string> split_delim(std::string input, std::string delim)
 {
     std::vector<std::string> tokens;
     std::size_t pos = 0;
@@ -171,71 +214,125 @@ std::vector<std::string> split_delim(std::string input, std::string delim)
     return tokens;
 }
 
-// Function that takes a queue as an input and outputs a string table of PCBs
-std::string print_PCB(std::vector<PCB> _PCB)
+// Writes value right-aligned in width columns (like std::setw), wider values are written whole
+template <typename T>
+inline char *write_right_aligned(char *cursor, T value, int width)
 {
-    const int tableWidth = 83;
+    char digits[24];
+    char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    for (int pad = width - (int)(end - digits); pad > 0; pad--)
+    {
+        *cursor++ = ' ';
+    }
+    return std::copy(digits, end, cursor);
+}
 
-    std::stringstream buffer;
+// Column widths of the PCB table (see print_PCB): PID, partition, size, arrival time, start time,
+// remaining time and state. A row is '|' followed by each field and " |".
+inline const int PCB_COLUMN_WIDTHS[] = {4, 11, 5, 13, 11, 14, 11};
 
-    // Print top border
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+// Appends one row of the PCB table to buffer. The row is copied from a blank template and each number
+// is formatted straight into the end of its slot; a field wider than its column (which setw would
+// let widen the row) takes the slower path that writes the row field by field.
+inline void append_PCB_row(std::string &buffer, const PCB &program)
+{
+    static const std::string blank = []()
+    {
+        std::string row = "|";
+        for (int width : PCB_COLUMN_WIDTHS)
+        {
+            row.append(width, ' ');
+            row += " |";
+        }
+        return row + "\n";
+    }();
+    const char *state_names[] = {"NEW", "READY", "RUNNING", "WAITING", "TERMINATED", "NOT_ASSIGNED",
+                                 "SUSPENDED_READY", "SUSPENDED_WAITING"};
+
+    long long values[] = {program.PID, program.partition_number, program.size, program.arrival_time,
+                          program.start_time, program.remaining_time};
+    const char *state = state_names[program.state];
+    int state_length = std::strlen(state);
+
+    std::size_t start = buffer.size();
+    buffer += blank;
+    char *slot = &buffer[start] + 1;
+    bool fits = state_length <= PCB_COLUMN_WIDTHS[6];
+    for (int field = 0; field < 6 && fits; field++)
+    {
+        char digits[24];
+        char *end = std::to_chars(digits, digits + sizeof(digits), values[field]).ptr;
+        int length = end - digits;
+        fits = length <= PCB_COLUMN_WIDTHS[field];
+        if (fits)
+        {
+            std::copy(digits, end, slot + PCB_COLUMN_WIDTHS[field] - length);
+        }
+        slot += PCB_COLUMN_WIDTHS[field] + 2;
+    }
+    if (fits)
+    {
+        std::copy(state, state + state_length, slot + PCB_COLUMN_WIDTHS[6] - state_length);
+        return;
+    }
 
-    // Print headers
-    buffer << "|"
-           << std::setfill(' ') << std::setw(4) << "PID"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(11) << "Partition"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(5) << "Size"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(13) << "Arrival Time"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(11) << "Start Time"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(14) << "Remaining Time"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(11) << "State"
-           << std::setw(2) << "|" << std::endl;
+    buffer.resize(start);
+    char row[256];
+    char *cursor = row;
+    *cursor++ = '|';
+    for (int field = 0; field < 6; field++)
+    {
+        cursor = write_right_aligned(cursor, values[field], PCB_COLUMN_WIDTHS[field]);
+        cursor = std::copy_n(" |", 2, cursor);
+    }
+    for (int pad = PCB_COLUMN_WIDTHS[6] - state_length; pad > 0; pad--)
+    {
+        *cursor++ = ' ';
+    }
+    cursor = std::copy(state, state + state_length, cursor);
+    cursor = std::copy_n(" |\n", 3, cursor);
+    buffer.append(row, cursor);
+}
 
-    // Print separator
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+// Appends the top border and the column headers of the PCB table
+inline void append_PCB_header(std::string &buffer)
+{
+    const char *border = "+----------------------------------------------------------------------------------+\n";
+    buffer += border;
+    buffer += "| PID |  Partition | Size | Arrival Time | Start Time |Remaining Time |      State |\n";
+    buffer += border;
+}
 
-    // Print each PCB entry
+inline void append_PCB_footer(std::string &buffer)
+{
+    buffer += "+----------------------------------------------------------------------------------+\n";
+}
+
+// Function that takes a queue as an input and outputs a string table of PCBs
+inline std::string print_PCB(const std::vector<PCB> &_PCB)
+{
+    std::string buffer;
+    buffer.reserve(3 * 86 + _PCB.size() * 86);
+    append_PCB_header(buffer);
     for (const auto &program : _PCB)
     {
-        buffer << "|"
-               << std::setfill(' ') << std::setw(4) << program.PID
-               << std::setw(2) << "|"
-               << std::setw(11) << program.partition_number
-               << std::setw(2) << "|"
-               << std::setw(5) << program.size
-               << std::setw(2) << "|"
-               << std::setw(13) << program.arrival_time
-               << std::setw(2) << "|"
-               << std::setw(11) << program.start_time
-               << std::setw(2) << "|"
-               << std::setw(14) << program.remaining_time
-               << std::setw(2) << "|"
-               << std::setw(11) << program.state
-               << std::setw(2) << "|" << std::endl;
+        append_PCB_row(buffer, program);
     }
-
-    // Print bottom border
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
-
-    return buffer.str();
+    append_PCB_footer(buffer);
+    return buffer;
 }
 
 // Overloaded function that takes a single PCB as input
-std::string print_PCB(PCB _PCB)
+inline std::string print_PCB(const PCB &_PCB)
 {
-    std::vector<PCB> temp;
-    temp.push_back(_PCB);
-    return print_PCB(temp);
+    std::string buffer;
+    append_PCB_header(buffer);
+    append_PCB_row(buffer, _PCB);
+    append_PCB_footer(buffer);
+    return buffer;
 }
 
-std::string print_exec_header()
+inline std::string print_exec_header()
 {
 
     const int tableWidth = 49;
@@ -262,39 +359,101 @@ std::string print_exec_header()
     return buffer.str();
 }
 
-std::string print_exec_status(unsigned int current_time, int PID, states old_state, states new_state)
+// Appends one row of the execution table (see print_exec_status) to buffer without any temporary
+// strings, so the simulation loop doesn't allocate per transition
+inline void append_exec_status(std::string &buffer, unsigned int current_time, int PID, states old_state, states new_state)
 {
+    const char *state_names[] = {"       NEW", "     READY", "   RUNNING", "   WAITING", "TERMINATED", "NOT_ASSIGNED",
+                                 "SUSPENDED_READY", "SUSPENDED_WAITING"};
+
+    char row[96];
+    char *cursor = row;
+    *cursor++ = '|';
+    cursor = write_right_aligned(cursor, current_time, 18);
+    cursor = std::copy_n(" |", 2, cursor);
+    cursor = write_right_aligned(cursor, PID, 3);
+    cursor = std::copy_n(" |", 2, cursor);
+    cursor = std::copy(state_names[old_state], state_names[old_state] + std::strlen(state_names[old_state]), cursor);
+    cursor = std::copy_n(" |", 2, cursor);
+    cursor = std::copy(state_names[new_state], state_names[new_state] + std::strlen(state_names[new_state]), cursor);
+    cursor = std::copy_n(" |\n", 3, cursor);
+    buffer.append(row, cursor);
+}
 
-    const int tableWidth = 49;
+inline std::string print_exec_status(unsigned int current_time, int PID, states old_state, states new_state)
+{
+    std::string buffer;
+    append_exec_status(buffer, current_time, PID, old_state, new_state);
+    return buffer;
+}
 
+inline std::string print_exec_footer()
+{
+    const int tableWidth = 49;
     std::stringstream buffer;
 
-    buffer << "|"
-           << std::setfill(' ') << std::setw(18) << current_time
-           << std::setw(2) << "|"
-           << std::setw(3) << PID
-           << std::setw(2) << "|"
-           << std::setw(10) << old_state
-           << std::setw(2) << "|"
-           << std::setw(10) << new_state
-           << std::setw(2) << "|" << std::endl;
+    // Print bottom border
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
 
     return buffer.str();
 }
 
-std::string print_exec_footer()
+// Per-process starvation counters of the terminated processes as CSV, followed by Jain's fairness
+// index over the normalized service (burst / turnaround) and an alert line for every process that
+// waited longer than max_wait_alert in READY or for memory
+inline std::string print_fairness_report(std::vector<PCB> finished, unsigned int max_wait_alert)
 {
-    const int tableWidth = 49;
+    std::sort(finished.begin(), finished.end(), [](const PCB &a, const PCB &b)
+              { return a.PID < b.PID; });
+
     std::stringstream buffer;
+    buffer << "PID,priority,arrival_time,finish_time,turnaround,memory_wait,ready_time,running_time,waiting_time,preemptions,io_waits,longest_ready_wait,suspended_time,swap_outs" << std::endl;
 
-    // Print bottom border
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+    double sum = 0;
+    double sum_squares = 0;
+    for (const auto &process : finished)
+    {
+        unsigned int turnaround = process.state_entered - process.arrival_time;
+        buffer << process.PID << ","
+               << process.priority << ","
+               << process.arrival_time << ","
+               << process.state_entered << ","
+               << turnaround << ","
+               << process.time_in_state[NEW] << ","
+               << process.time_in_state[READY] << ","
+               << process.time_in_state[RUNNING] << ","
+               << process.time_in_state[WAITING] << ","
+               << process.preemptions << ","
+               << process.io_waits << ","
+               << process.longest_ready_wait << ","
+               << process.time_in_state[SUSPENDED_READY] + process.time_in_state[SUSPENDED_WAITING] << ","
+               << process.swap_outs << std::endl;
+
+        double service = (turnaround > 0) ? (double)process.processing_time / turnaround : 1.0;
+        sum += service;
+        sum_squares += service * service;
+    }
+
+    double jain = (sum_squares > 0) ? (sum * sum) / (finished.size() * sum_squares) : 1.0;
+    buffer << "# jain_fairness_index," << std::fixed << std::setprecision(4) << jain << std::endl;
+
+    for (const auto &process : finished)
+    {
+        if (process.longest_ready_wait > max_wait_alert)
+        {
+            buffer << "# ALERT PID " << process.PID << " waited " << process.longest_ready_wait << "ms in READY" << std::endl;
+        }
+        if (process.time_in_state[NEW] > max_wait_alert)
+        {
+            buffer << "# ALERT PID " << process.PID << " waited " << process.time_in_state[NEW] << "ms for memory" << std::endl;
+        }
+    }
 
     return buffer.str();
 }
 
 // Synchronize the process in the process queue
-void sync_queue(std::vector<PCB> &process_queue, PCB _process)
+inline void sync_queue(std::vector<PCB> &process_queue, PCB _process)
 {
     for (auto &process : process_queue)
     {
@@ -305,8 +464,8 @@ void sync_queue(std::vector<PCB> &process_queue, PCB _process)
     }
 }
 
-// Writes a string to a file
-void write_output(std::string execution, const char *filename)
+// Writes a string to a file, and two status lines to status unless it is null
+inline void write_output(std::string execution, const char *filename, std::ostream *status = &std::cout)
 {
     std::ofstream output_file(filename);
 
@@ -314,25 +473,32 @@ void write_output(std::string execution, const char *filename)
     {
         output_file << execution;
         output_file.close(); // Close the file when done
-        std::cout << "File content overwritten successfully." << std::endl;
+        if (status != nullptr)
+        {
+            *status << "File content overwritten successfully." << std::endl;
+        }
     }
     else
     {
         std::cerr << "Error opening file!" << std::endl;
     }
 
-    std::cout << "Output generated in " << filename << ".txt" << std::endl;
+    if (status != nullptr)
+    {
+        *status << "Output generated in " << filename << ".txt" << std::endl;
+    }
 }
 
 //--------------------------------------------FUNCTIONS FOR THE "OS"-------------------------------------
 
-// Assign memory partition to program
-bool assign_memory(PCB &program)
+// Assign memory partition to program, trying the partitions from the end of the table (the smallest
+// ones in the default layout) first
+inline bool assign_memory(std::vector<memory_partition> &memory_partitions, PCB &program)
 {
     int size_to_fit = program.size;
     int available_size = 0;
 
-    for (int i = 5; i >= 0; i--)
+    for (int i = (int)memory_partitions.size() - 1; i >= 0; i--)
     {
         available_size = memory_partitions[i].size;
 
@@ -348,9 +514,9 @@ bool assign_memory(PCB &program)
 }
 
 // Free a memory partition
-bool free_memory(PCB &program)
+inline bool free_memory(std::vector<memory_partition> &memory_partitions, PCB &program)
 {
-    for (int i = 5; i >= 0; i--)
+    for (int i = (int)memory_partitions.size() - 1; i >= 0; i--)
     {
         if (program.PID == memory_partitions[i].occupied)
         {
@@ -363,39 +529,41 @@ bool free_memory(PCB &program)
 }
 
 // Print the memory usage for the bonus task
-void print_memory_usage(unsigned int current_time)
+inline void print_memory_usage(const std::vector<memory_partition> &memory_partitions, unsigned int current_time,
+                               std::ostream &output = std::cout)
 {
     int total_used = 0;
     int total_free = 0;
-    std::cout << "[Memory at " << current_time << "ms] ";
-    for (int i = 0; i < 6; i++)
+    output << "[Memory at " << current_time << "ms] ";
+    for (std::size_t i = 0; i < memory_partitions.size(); i++)
     {
         if (memory_partitions[i].occupied != -1)
         {
             total_used += memory_partitions[i].size;
-            std::cout << "[P" << memory_partitions[i].partition_number << ":" << memory_partitions[i].occupied << "] ";
+            output << "[P" << memory_partitions[i].partition_number << ":" << memory_partitions[i].occupied << "] ";
         }
         else
         {
             total_free += memory_partitions[i].size; // Count free/usable memory
-            std::cout << "[P" << memory_partitions[i].partition_number << ":FREE] ";
+            output << "[P" << memory_partitions[i].partition_number << ":FREE] ";
         }
     }
-    std::cout << "\nTotal Used: " << total_used << "Mb";
-    std::cout << "\nTotal Free (Usable): " << total_free << "Mb" << std::endl;
+    output << "\nTotal Used: " << total_used << "Mb";
+    output << "\nTotal Free (Usable): " << total_free << "Mb" << std::endl;
 }
 
-// Convert a list of strings into a PCB
-PCB add_process(std::vector<std::string> tokens)
+// Build a new PCB from the input columns
+inline PCB make_process(int PID, unsigned int size, unsigned int arrival_time, unsigned int processing_time,
+                 unsigned int io_freq, unsigned int io_duration, int priority)
 {
     PCB process;
-    process.PID = std::stoi(tokens[0]);
-    process.size = std::stoi(tokens[1]);
-    process.arrival_time = std::stoi(tokens[2]);
-    process.processing_time = std::stoi(tokens[3]);
-    process.remaining_time = std::stoi(tokens[3]);
-    process.io_freq = std::stoi(tokens[4]);
-    process.io_duration = std::stoi(tokens[5]);
+    process.PID = PID;
+    process.size = size;
+    process.arrival_time = arrival_time;
+    process.processing_time = processing_time;
+    process.remaining_time = processing_time;
+    process.io_freq = io_freq;
+    process.io_duration = io_duration;
     process.start_time = -1;
     process.partition_number = -1;
     process.state = NOT_ASSIGNED;
@@ -404,11 +572,349 @@ PCB add_process(std::vector<std::string> tokens)
     process.time_since_io = 0;
     process.io_return_time = 0;
 
+    process.priority = priority;
+    process.ready_since = 0;
+
+    process.state_entered = process.arrival_time;
+    std::fill(std::begin(process.time_in_state), std::end(process.time_in_state), 0);
+    process.preemptions = 0;
+    process.io_waits = 0;
+    process.swap_outs = 0;
+    process.longest_ready_wait = 0;
+
+    process.burst_first = 0;
+    process.burst_end = 0;
+    process.burst_cursor = 0;
+    process.burst_repeats = 0;
+    process.bursts_issued = 0;
+
     return process;
 }
 
+// Convert a list of strings into a PCB
+inline PCB add_process(std::vector<std::string> tokens)
+{
+    int PID = std::stoi(tokens[0]);
+
+    // Optional 7th column is an explicit priority, otherwise fall back to PID-as-priority
+    int priority = (tokens.size() > 6) ? std::stoi(tokens[6]) : PID;
+
+    return make_process(PID, std::stoi(tokens[1]), std::stoi(tokens[2]), std::stoi(tokens[3]),
+                        std::stoi(tokens[4]), std::stoi(tokens[5]), priority);
+}
+
+//------------------------------------------------I/O PROFILES-------------------------------------------
+
+enum burst_kind
+{
+    BURST_FIXED,      // cpu ms, then io ms
+    BURST_EXPONENTIAL // each burst drawn from exponentials with means cpu and io
+};
+
+// One run of a process's I/O profile: repeat bursts of CPU followed by I/O. A fixed run without I/O
+// (io 0) can only end a profile, the process then computes until its processing time is used up;
+// otherwise the profile starts over after its last run. Runs of all processes share one array and
+// each PCB holds its range and a cursor, so a profile costs 16 bytes per distinct run however long
+// the process lives.
+struct burst_run
+{
+    uint32_t cpu;
+    uint32_t io;
+    uint32_t repeat; // bursts in the run, 0 = for ever
+    uint32_t kind;   // burst_kind
+};
+
+// splitmix64 finalizer: a well mixed 64-bit value from a counter, for reproducible draws
+inline uint64_t splitmix64(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// Loads the burst under the process's cursor into io_freq and io_duration
+inline void load_burst(PCB &process, const std::vector<burst_run> &bursts)
+{
+    const burst_run &run = bursts[process.burst_cursor];
+    if (run.kind == BURST_FIXED)
+    {
+        process.io_freq = (run.io > 0) ? run.cpu : 0;
+        process.io_duration = run.io;
+        return;
+    }
+
+    // two uniforms per burst, numbered by PID and burst, so every run draws the same bursts
+    uint64_t draw = ((uint64_t)(uint32_t)process.PID << 32) | ((uint64_t)process.bursts_issued << 1);
+    double cpu_uniform = (splitmix64(draw) >> 11) * 0x1.0p-53;
+    double io_uniform = (splitmix64(draw | 1) >> 11) * 0x1.0p-53;
+    process.io_freq = (unsigned int)std::max(1.0, std::round(-(double)run.cpu * std::log1p(-cpu_uniform)));
+    process.io_duration = (unsigned int)std::max(1.0, std::round(-(double)run.io * std::log1p(-io_uniform)));
+}
+
+// Called when the current burst issued its I/O: moves the cursor on and loads the next burst
+inline void advance_burst(PCB &process, const std::vector<burst_run> &bursts)
+{
+    process.bursts_issued += 1;
+    process.burst_repeats += 1;
+    const burst_run &run = bursts[process.burst_cursor];
+    if (run.repeat != 0 && process.burst_repeats >= run.repeat)
+    {
+        process.burst_repeats = 0;
+        process.burst_cursor += 1;
+        if (process.burst_cursor == process.burst_end)
+        {
+            process.burst_cursor = process.burst_first;
+        }
+    }
+    load_burst(process, bursts);
+}
+
+// Whether [begin, end) holds only spaces, tabs and carriage returns
+inline bool is_blank(const char *begin, const char *end)
+{
+    for (; begin < end; begin++)
+    {
+        if (*begin != ' ' && *begin != '\t' && *begin != '\r')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parses a whole field as an integer, allowing spaces around it
+inline bool parse_integer(const char *begin, const char *end, long long &value)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+        begin++;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+        end--;
+    auto [stop, error] = std::from_chars(begin, end, value);
+    return begin < end && error == std::errc() && stop == end;
+}
+
+// Parses an I/O profile, space separated runs of
+//     CPU/IO[*N]        N bursts (default 1) of CPU ms then IO ms
+//     exp(CPU/IO)[*N]   N bursts (default for ever) drawn with means CPU and IO
+//     CPU               a last burst without I/O
+// e.g. "30/10 20/5*4 exp(25/12)*10 40", and appends its runs to bursts
+inline bool parse_burst_profile(const char *begin, const char *end, std::vector<burst_run> &bursts)
+{
+    std::size_t first = bursts.size();
+    const char *cursor = begin;
+    while (true)
+    {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+            cursor++;
+        if (cursor == end)
+        {
+            break;
+        }
+        if (!bursts.empty() && bursts.size() > first && bursts.back().io == 0)
+        {
+            return false; // only the last run can be without I/O
+        }
+
+        burst_run run = {0, 0, 1, BURST_FIXED};
+        bool exponential = (end - cursor > 4 && std::equal(cursor, cursor + 4, "exp("));
+        if (exponential)
+        {
+            cursor += 4;
+            run.kind = BURST_EXPONENTIAL;
+            run.repeat = 0;
+        }
+
+        auto cpu = std::from_chars(cursor, end, run.cpu);
+        if (cpu.ec != std::errc() || run.cpu == 0)
+        {
+            return false;
+        }
+        cursor = cpu.ptr;
+        if (cursor < end && *cursor == '/')
+        {
+            auto io = std::from_chars(cursor + 1, end, run.io);
+            if (io.ec != std::errc() || run.io == 0)
+            {
+                return false;
+            }
+            cursor = io.ptr;
+        }
+        else if (exponential)
+        {
+            return false;
+        }
+        if (exponential && (cursor == end || *cursor++ != ')'))
+        {
+            return false;
+        }
+        if (cursor < end && *cursor == '*')
+        {
+            auto repeat = std::from_chars(cursor + 1, end, run.repeat);
+            if (repeat.ec != std::errc() || run.repeat == 0 || run.io == 0)
+            {
+                return false;
+            }
+            cursor = repeat.ptr;
+        }
+        if (cursor < end && *cursor != ' ' && *cursor != '\t' && *cursor != '\r')
+        {
+            return false;
+        }
+        bursts.push_back(run);
+    }
+    return bursts.size() > first;
+}
+
+// Parses one input line, "PID, size, arrival, burst, io_freq, io_duration[, priority][, profile]",
+// where the profile may also take the place of the priority. Returns false on a malformed line.
+inline bool parse_process_line(const char *begin, const char *end, PCB &process, std::vector<burst_run> &bursts)
+{
+    const char *fields[9];
+    const char *field_ends[9];
+    int count = 0;
+    for (const char *field = begin; count < 9;)
+    {
+        const char *comma = std::find(field, end, ',');
+        fields[count] = field;
+        field_ends[count] = comma;
+        count += 1;
+        if (comma == end)
+        {
+            break;
+        }
+        field = comma + 1;
+    }
+    if (count < 6 || count > 8)
+    {
+        return false;
+    }
+
+    long long values[7];
+    for (int i = 0; i < 6; i++)
+    {
+        if (!parse_integer(fields[i], field_ends[i], values[i]) || values[i] < 0 || values[i] > INT32_MAX)
+        {
+            return false;
+        }
+    }
+
+    // Optional 7th column is an explicit priority, otherwise fall back to PID-as-priority
+    int profile_field = -1;
+    values[6] = values[0];
+    if (count >= 7 && !parse_integer(fields[6], field_ends[6], values[6]))
+    {
+        profile_field = (count == 7) ? 6 : -1;
+        if (profile_field == -1 || values[6] < INT32_MIN || values[6] > INT32_MAX)
+        {
+            return false;
+        }
+        values[6] = values[0];
+    }
+    if (count == 8)
+    {
+        profile_field = 7;
+    }
+
+    process = make_process((int)values[0], values[1], values[2], values[3], values[4], values[5], (int)values[6]);
+    if (profile_field != -1)
+    {
+        std::size_t first = bursts.size();
+        if (!parse_burst_profile(fields[profile_field], field_ends[profile_field], bursts))
+        {
+            bursts.resize(first);
+            return false;
+        }
+        process.burst_first = process.burst_cursor = first;
+        process.burst_end = bursts.size();
+        load_burst(process, bursts);
+    }
+    return true;
+}
+
+// Calls handle(line_number, begin, end) for every line of input, without the newline. The input is
+// read in 1MB blocks and handed out in place, with no string per line.
+template <typename Handler>
+inline void for_each_line(std::istream &input, Handler &&handle)
+{
+    std::vector<char> buffer(1 << 20);
+    std::size_t used = 0;
+    unsigned long long line_number = 0;
+
+    while (true)
+    {
+        if (used == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2); // a line longer than the buffer
+        }
+        input.read(buffer.data() + used, buffer.size() - used);
+        std::size_t read = input.gcount();
+        used += read;
+        bool at_end = (read == 0);
+
+        const char *line = buffer.data();
+        const char *stop = buffer.data() + used;
+        while (line < stop)
+        {
+            const char *newline = std::find(line, stop, '\n');
+            if (newline == stop && !at_end)
+            {
+                break; // the rest of the line is in the next block
+            }
+            line_number += 1;
+            handle(line_number, line, newline);
+            line = (newline == stop) ? stop : newline + 1;
+        }
+
+        used = stop - line;
+        std::copy(line, stop, buffer.data());
+        if (at_end)
+        {
+            break;
+        }
+    }
+}
+
+// Parse a whole trace, one process per line; blank lines are skipped and a malformed line throws
+// std::invalid_argument naming its line number. The numbers are parsed in place with std::from_chars.
+// This only checks the syntax, see trace_check.hpp for the checks against the simulator's limits.
+inline std::vector<PCB> read_processes(std::istream &input, std::vector<burst_run> &bursts)
+{
+    std::vector<PCB> list_process;
+    for_each_line(input, [&](unsigned long long line_number, const char *begin, const char *end)
+                  {
+                      PCB process;
+                      if (is_blank(begin, end))
+                      {
+                          return;
+                      }
+                      if (!parse_process_line(begin, end, process, bursts))
+                      {
+                          throw std::invalid_argument("line " + std::to_string(line_number) + ": " + std::string(begin, end));
+                      }
+                      list_process.push_back(process);
+                  });
+    return list_process;
+}
+
+// Same, for callers without I/O profiles: a process with a profile throws std::invalid_argument
+// naming its PID rather than quietly running its first burst only
+inline std::vector<PCB> read_processes(std::istream &input)
+{
+    std::vector<burst_run> bursts;
+    std::vector<PCB> list_process = read_processes(input, bursts);
+    for (const auto &process : list_process)
+    {
+        if (process.burst_first != process.burst_end)
+        {
+            throw std::invalid_argument("PID " + std::to_string(process.PID) + " has an I/O profile, read it with the bursts");
+        }
+    }
+    return list_process;
+}
+
 // Returns true if all processes in the queue have terminated
-bool all_process_terminated(std::vector<PCB> processes)
+inline bool all_process_terminated(std::vector<PCB> processes)
 {
 
     for (auto process : processes)
@@ -423,16 +929,16 @@ bool all_process_terminated(std::vector<PCB> processes)
 }
 
 // Terminates a given process
-void terminate_process(PCB &running, std::vector<PCB> &job_queue)
+inline void terminate_process(std::vector<memory_partition> &memory_partitions, PCB &running, std::vector<PCB> &job_queue)
 {
     running.remaining_time = 0;
     running.state = TERMINATED;
-    free_memory(running);
+    free_memory(memory_partitions, running);
     sync_queue(job_queue, running);
 }
 
 // set the process in the ready queue to runnning
-void run_process(PCB &running, std::vector<PCB> &job_queue, std::vector<PCB> &ready_queue, unsigned int current_time)
+inline void run_process(PCB &running, std::vector<PCB> &job_queue, std::vector<PCB> &ready_queue, unsigned int current_time)
 {
     running = ready_queue.back();
     ready_queue.pop_back();
@@ -441,7 +947,7 @@ void run_process(PCB &running, std::vector<PCB> &job_queue, std::vector<PCB> &re
     sync_queue(job_queue, running);
 }
 
-void idle_CPU(PCB &running)
+inline void idle_CPU(PCB &running)
 {
     running.start_time = 0;
     running.processing_time = 0;
@@ -453,6 +959,8 @@ void idle_CPU(PCB &running)
     running.size = 0;
     running.state = NOT_ASSIGNED;
     running.PID = -1;
+    running.priority = 0;
+    running.ready_since = 0;
 }
 
 #endif
\ No newline at end of file
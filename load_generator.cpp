@@ -0,0 +1,432 @@
+/**
+ * @file load_generator.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Continuous runs: jobs generated on the fly from a rate model, steady-state statistics
+ *
+ */
+
+#include <load_generator.hpp>
+
+#include <cmath>
+#include <functional>
+
+int latency_bucket(unsigned int latency)
+{
+    if (latency < latency_histogram::SUB_BUCKETS)
+    {
+        return latency;
+    }
+    int exponent = 31 - __builtin_clz(latency); // at least 4
+    int sub_bucket = (latency >> (exponent - 4)) - latency_histogram::SUB_BUCKETS;
+    return latency_histogram::SUB_BUCKETS * (exponent - 3) + sub_bucket;
+}
+
+unsigned int bucket_floor(int bucket)
+{
+    if (bucket < latency_histogram::SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    int exponent = bucket / latency_histogram::SUB_BUCKETS + 3;
+    unsigned int mantissa = latency_histogram::SUB_BUCKETS + bucket % latency_histogram::SUB_BUCKETS;
+    return mantissa << (exponent - 4);
+}
+
+void add_latency(latency_histogram &histogram, unsigned int latency)
+{
+    histogram.counts[latency_bucket(latency)] += 1;
+    histogram.total += 1;
+}
+
+unsigned int latency_percentile(const latency_histogram &histogram, double percentile)
+{
+    if (histogram.total == 0)
+    {
+        return 0;
+    }
+    unsigned long long rank = (unsigned long long)std::ceil(percentile / 100 * histogram.total);
+    unsigned long long seen = 0;
+    for (int bucket = 0; bucket < latency_histogram::BUCKETS; bucket++)
+    {
+        seen += histogram.counts[bucket];
+        if (seen >= std::max(rank, 1ULL))
+        {
+            return bucket_floor(bucket);
+        }
+    }
+    return bucket_floor(latency_histogram::BUCKETS - 1);
+}
+
+// Two-sided 95% Student-t quantile for df degrees of freedom
+static double t_quantile(unsigned long long df)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df == 0)
+    {
+        return 0;
+    }
+    if (df <= 30)
+    {
+        return table[df - 1];
+    }
+    return 1.96 + 2.4 / df; // within 0.005 of the exact value from there on
+}
+
+// Welford's running mean and variance of the batch means
+struct batch_means
+{
+    unsigned long long count = 0;
+    double mean = 0;
+    double squares = 0;
+
+    void add(double value)
+    {
+        count += 1;
+        double delta = value - mean;
+        mean += delta / count;
+        squares += delta * (value - mean);
+    }
+
+    steady_estimate estimate() const
+    {
+        steady_estimate result;
+        result.mean = mean;
+        if (count > 1)
+        {
+            result.half_width = t_quantile(count - 1) * std::sqrt(squares / (count - 1) / count);
+        }
+        return result;
+    }
+};
+
+// Completions between two rows
+struct slide_stats
+{
+    unsigned long long completions = 0;
+    double latency_sum = 0;
+    double wait_sum = 0;
+    latency_histogram latencies;
+};
+
+bool check_load_config(const load_config &load, const SimConfig &config, const std::vector<PCB> &mix, std::string &error)
+{
+    if (mix.empty())
+    {
+        error = "the job mix is empty";
+        return false;
+    }
+    if (config.frames > 0)
+    {
+        error = "continuous runs don't support paged memory";
+        return false;
+    }
+    if (load.slide == 0 || load.window % load.slide != 0)
+    {
+        error = "the window must be a positive multiple of the slide";
+        return false;
+    }
+    if (load.model == OPEN_LOOP && !(load.arrival_rate > 0))
+    {
+        error = "the arrival rate must be positive";
+        return false;
+    }
+    if (load.model == CLOSED_LOOP && load.clients == 0)
+    {
+        error = "a closed loop needs at least one client";
+        return false;
+    }
+
+    // A job larger than every partition would wait for memory for ever and pile up
+    unsigned int largest = 0;
+    for (const auto &partition : config.partitions)
+    {
+        largest = std::max(largest, partition.size);
+    }
+    for (const auto &job : mix)
+    {
+        if (job.size > largest)
+        {
+            error = "PID " + std::to_string(job.PID) + " needs " + std::to_string(job.size) + "MB, the largest partition is " +
+                    std::to_string(largest) + "MB";
+            return false;
+        }
+    }
+    return true;
+}
+
+class steady_state_driver : public SimObserver
+{
+public:
+    steady_state_driver(const SimConfig &config, const load_config &load, const std::vector<PCB> &mix,
+                        const std::vector<burst_run> &bursts, std::ostream *rows)
+        : simulator(config), load(load), mix(mix), bursts(bursts), rows(rows), random(load.seed),
+          slides(load.window / load.slide), window(slides)
+    {
+        simulator.add_observer(this);
+        simulator.load({}, bursts);
+    }
+
+    steady_state_result run()
+    {
+        if (rows != nullptr)
+        {
+            *rows << "end_ms,completions,throughput_per_s,mean_latency_ms,mean_wait_ms,p50_latency_ms,p99_latency_ms,live\n";
+        }
+
+        // Every client thinks before its first job, so they don't all start at once
+        double next_arrival = 0;
+        if (load.model == OPEN_LOOP)
+        {
+            next_arrival = exponential(1000.0 / load.arrival_rate);
+        }
+        else
+        {
+            submissions.reserve(load.clients);
+            for (uint32_t client = 0; client < load.clients; client++)
+            {
+                schedule_submission(0, client);
+            }
+        }
+
+        unsigned long long next_row = (unsigned long long)load.warmup + load.slide;
+        while (simulator.now() < load.duration)
+        {
+            unsigned int now = simulator.now();
+            if (now >= load.warmup && current == nullptr)
+            {
+                current = &window[0];
+            }
+            while (now >= next_row)
+            {
+                close_slide((unsigned int)next_row);
+                next_row += load.slide;
+            }
+
+            if (load.model == OPEN_LOOP)
+            {
+                while (std::ceil(next_arrival) <= now)
+                {
+                    if (live < load.max_live)
+                    {
+                        submit(now, 0);
+                    }
+                    else
+                    {
+                        result.dropped += 1;
+                    }
+                    next_arrival += exponential(1000.0 / load.arrival_rate);
+                }
+            }
+            else
+            {
+                while (!submissions.empty() && submissions.front().first <= now)
+                {
+                    uint32_t client = submissions.front().second;
+                    std::pop_heap(submissions.begin(), submissions.end(), std::greater<>());
+                    submissions.pop_back();
+                    submit(now, client);
+                }
+            }
+            simulator.step();
+        }
+
+        result.batches = throughput.count;
+        result.throughput = throughput.estimate();
+        result.latency = latency.estimate();
+        result.wait = wait.estimate();
+        result.p50_latency = latency_percentile(all_latencies, 50);
+        result.p99_latency = latency_percentile(all_latencies, 99);
+        result.table_slots = simulator.processes().pcb.size();
+        result.transitions = simulator.transition_count();
+        return result;
+    }
+
+    void on_transition(const sim_transition &transition) override
+    {
+        if (transition.new_state != TERMINATED)
+        {
+            return;
+        }
+        const PCB &job = simulator.processes().pcb[transition.process];
+        live -= 1;
+        result.completed += 1;
+        if (current != nullptr)
+        {
+            unsigned int job_latency = transition.time - job.arrival_time;
+            current->completions += 1;
+            current->latency_sum += job_latency;
+            current->wait_sum += job.time_in_state[READY];
+            add_latency(current->latencies, job_latency);
+            add_latency(all_latencies, job_latency);
+        }
+        if (load.model == CLOSED_LOOP)
+        {
+            schedule_submission(transition.time, client_of[transition.process]);
+        }
+    }
+
+private:
+    double exponential(double mean)
+    {
+        double uniform = (random() >> 11) * 0x1.0p-53;
+        return -mean * std::log1p(-uniform);
+    }
+
+    void schedule_submission(unsigned int time, uint32_t client)
+    {
+        submissions.emplace_back(time + (unsigned int)std::ceil(exponential(load.think_time)), client);
+        std::push_heap(submissions.begin(), submissions.end(), std::greater<>());
+    }
+
+    // Adds a copy of a random job of the mix arriving now, with a PID of its own
+    void submit(unsigned int now, uint32_t client)
+    {
+        const PCB &model = mix[random() % mix.size()];
+        result.submitted += 1;
+        PCB job = make_process((int)(result.submitted & INT32_MAX), model.size, now, model.processing_time,
+                               model.io_freq, model.io_duration, model.priority);
+        job.burst_first = job.burst_cursor = model.burst_first;
+        job.burst_end = model.burst_end;
+        if (job.burst_first != job.burst_end)
+        {
+            load_burst(job, bursts);
+        }
+
+        uint32_t index = simulator.spawn(job);
+        if (index >= client_of.size())
+        {
+            client_of.resize(index + 1);
+        }
+        client_of[index] = client;
+        live += 1;
+        result.peak_live = std::max(result.peak_live, live);
+    }
+
+    // Writes the row of the window ending at end and starts the next slide
+    void close_slide(unsigned int end)
+    {
+        closed_slides += 1;
+        if (closed_slides >= slides)
+        {
+            slide_stats total;
+            for (const auto &slide : window)
+            {
+                total.completions += slide.completions;
+                total.latency_sum += slide.latency_sum;
+                total.wait_sum += slide.wait_sum;
+                for (int bucket = 0; bucket < latency_histogram::BUCKETS; bucket++)
+                {
+                    total.latencies.counts[bucket] += slide.latencies.counts[bucket];
+                }
+                total.latencies.total += slide.latencies.total;
+            }
+
+            window_stats row;
+            row.end = end;
+            row.completions = total.completions;
+            row.throughput = total.completions * 1000.0 / load.window;
+            row.mean_latency = (total.completions > 0) ? total.latency_sum / total.completions : 0;
+            row.mean_wait = (total.completions > 0) ? total.wait_sum / total.completions : 0;
+            row.p50_latency = latency_percentile(total.latencies, 50);
+            row.p99_latency = latency_percentile(total.latencies, 99);
+            row.live = live;
+            write_row(row);
+
+            // Windows that don't overlap are the batches of the confidence intervals
+            if (closed_slides % slides == 0)
+            {
+                throughput.add(row.throughput);
+                if (total.completions > 0)
+                {
+                    latency.add(row.mean_latency);
+                    wait.add(row.mean_wait);
+                }
+            }
+        }
+
+        current = &window[closed_slides % slides];
+        *current = slide_stats();
+    }
+
+    void write_row(const window_stats &row)
+    {
+        if (rows == nullptr)
+        {
+            return;
+        }
+        char line[192];
+        std::snprintf(line, sizeof(line), "%u,%llu,%.3f,%.3f,%.3f,%u,%u,%u\n", row.end, row.completions, row.throughput,
+                      row.mean_latency, row.mean_wait, row.p50_latency, row.p99_latency, row.live);
+        *rows << line;
+    }
+
+    Simulator simulator;
+    const load_config &load;
+    const std::vector<PCB> &mix;
+    const std::vector<burst_run> &bursts;
+    std::ostream *rows;
+    std::mt19937_64 random;
+
+    std::vector<std::pair<unsigned int, uint32_t>> submissions; // closed loop: (time, client), min-heap
+    std::vector<uint32_t> client_of;                             // client of the job in each table slot
+    uint32_t live = 0;
+
+    // The last window, one slide_stats per slide, used round robin; current is null during the warm-up
+    unsigned int slides;
+    std::vector<slide_stats> window;
+    slide_stats *current = nullptr;
+    unsigned long long closed_slides = 0;
+
+    latency_histogram all_latencies;
+    batch_means throughput;
+    batch_means latency;
+    batch_means wait;
+    steady_state_result result;
+};
+
+steady_state_result run_steady_state(const SimConfig &config, const load_config &load, const std::vector<PCB> &mix,
+                                     const std::vector<burst_run> &bursts, std::ostream *rows)
+{
+    SimConfig continuous = config;
+    continuous.recycle_terminated = true;
+    continuous.record_execution = false; // the table would grow with the run
+    continuous.execution_output = nullptr;
+
+    steady_state_driver driver(continuous, load, mix, bursts, rows);
+    return driver.run();
+}
+
+std::string print_steady_state(const steady_state_result &result, const load_config &load)
+{
+    std::string report;
+    char line[256];
+    if (load.model == OPEN_LOOP)
+    {
+        std::snprintf(line, sizeof(line), "Steady state (open loop, %g jobs/s)", load.arrival_rate);
+    }
+    else
+    {
+        std::snprintf(line, sizeof(line), "Steady state (closed loop, %u clients, %gms think time)", load.clients, load.think_time);
+    }
+    report += line;
+    std::snprintf(line, sizeof(line), " over %llu batches of %ums after %ums of warm-up, 95%% confidence:\n",
+                  result.batches, load.window, load.warmup);
+    report += line;
+    std::snprintf(line, sizeof(line), "  throughput  %10.3f jobs/s +- %.3f\n", result.throughput.mean, result.throughput.half_width);
+    report += line;
+    std::snprintf(line, sizeof(line), "  latency     %10.3f ms     +- %.3f (p50 %ums, p99 %ums)\n", result.latency.mean,
+                  result.latency.half_width, result.p50_latency, result.p99_latency);
+    report += line;
+    std::snprintf(line, sizeof(line), "  ready wait  %10.3f ms     +- %.3f\n", result.wait.mean, result.wait.half_width);
+    report += line;
+    std::snprintf(line, sizeof(line), "Jobs: %llu submitted, %llu completed, %llu dropped, at most %u alive in %zu table slots, %llu transitions\n",
+                  result.submitted, result.completed, result.dropped, result.peak_live, result.table_slots, result.transitions);
+    report += line;
+    if (result.batches < 2)
+    {
+        report += "Fewer than 2 batches: run longer or shorten the window for confidence intervals\n";
+    }
+    return report;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file load_generator.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Continuous runs: jobs generated on the fly from a rate model, steady-state statistics
+ *
+ * Instead of running a finite trace to completion, run_steady_state() keeps a Simulator busy for a
+ * given simulated time with jobs drawn at random from a job mix (a parsed trace, arrival times
+ * ignored). The jobs come either
+ *  - open loop: a Poisson process of arrival_rate jobs per second, whatever the system does, or
+ *  - closed loop: clients that each submit a job, wait for it to finish, think for an exponential
+ *    time of mean think_time, then submit the next one.
+ * Terminated processes hand their table slot to the next job (SimConfig::recycle_terminated), so the
+ * memory of a run is set by the most jobs alive at once, not by its length; max_live caps that for
+ * an overloaded open loop by dropping the arrivals that would exceed it.
+ *
+ * Statistics start after the warm-up. Every slide ms a row describes the last window ms (throughput,
+ * mean and percentile latency, jobs alive); the latencies are bucketed in a log-linear histogram of
+ * fixed size per slide, so the rows cost O(1) memory. The summary treats consecutive, non-overlapping
+ * windows as batches: its means come with 95% Student-t confidence intervals over the batch means.
+ */
+
+#ifndef LOAD_GENERATOR_HPP_
+#define LOAD_GENERATOR_HPP_
+
+#include <simulator.hpp>
+
+enum load_model
+{
+    OPEN_LOOP,  // Poisson arrivals at arrival_rate
+    CLOSED_LOOP // clients with think time
+};
+
+struct load_config
+{
+    load_model model = OPEN_LOOP;
+    double arrival_rate = 10;     // open loop: jobs per second of simulated time
+    unsigned int clients = 10;    // closed loop
+    double think_time = 100;      // closed loop: mean ms between a job's end and the client's next job
+    unsigned int duration = 3600000; // ms simulated
+    unsigned int warmup = 60000;  // ms before the statistics start
+    unsigned int window = 60000;  // ms covered by a row and by a batch of the confidence intervals
+    unsigned int slide = 60000;   // ms between rows, window must be a multiple of it
+    uint32_t max_live = 1000000;  // open loop: arrivals beyond this many jobs in the system are dropped
+    uint64_t seed = 1;
+};
+
+// Latency histogram with 16 buckets per power of two (6% wide at most), exact below 16ms
+struct latency_histogram
+{
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = (32 - 3) * SUB_BUCKETS;
+    uint32_t counts[BUCKETS] = {};
+    unsigned long long total = 0;
+};
+
+// Bucket of a latency and the smallest latency it holds
+int latency_bucket(unsigned int latency);
+unsigned int bucket_floor(int bucket);
+
+void add_latency(latency_histogram &histogram, unsigned int latency);
+unsigned int latency_percentile(const latency_histogram &histogram, double percentile);
+
+// One row of the report: the window ending at end
+struct window_stats
+{
+    unsigned int end;
+    unsigned long long completions;
+    double throughput;   // jobs per second
+    double mean_latency; // ms from arrival to termination
+    double mean_wait;    // ms spent READY
+    unsigned int p50_latency;
+    unsigned int p99_latency;
+    uint32_t live; // jobs in the system at end
+};
+
+// Mean of the batch means and the half width of its 95% confidence interval
+struct steady_estimate
+{
+    double mean = 0;
+    double half_width = 0;
+};
+
+struct steady_state_result
+{
+    unsigned long long batches = 0;
+    steady_estimate throughput; // jobs per second
+    steady_estimate latency;    // ms
+    steady_estimate wait;       // ms
+    unsigned int p50_latency = 0;
+    unsigned int p99_latency = 0;
+
+    unsigned long long submitted = 0; // every job, warm-up included
+    unsigned long long completed = 0;
+    unsigned long long dropped = 0; // open loop arrivals over max_live
+    uint32_t peak_live = 0;
+    std::size_t table_slots = 0; // process table size at the end
+    unsigned long long transitions = 0;
+};
+
+// Checks a load config, false with a message in error when it can't run
+bool check_load_config(const load_config &load, const SimConfig &config, const std::vector<PCB> &mix, std::string &error);
+
+// Runs config on jobs drawn from mix (with its I/O profile runs in bursts) under load, writing a CSV
+// row per slide after the warm-up to rows when it is set
+steady_state_result run_steady_state(const SimConfig &config, const load_config &load, const std::vector<PCB> &mix,
+                                     const std::vector<burst_run> &bursts, std::ostream *rows);
+
+// The summary as printed by the steady_state program
+std::string print_steady_state(const steady_state_result &result, const load_config &load);
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * @file paging.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Paged memory for the simulator: page tables, a frame pool, page replacement and a TLB
+ *
+ * With SimConfig::frames > 0 the partitions are replaced by a pool of frames shared by every process.
+ * A process has one page per MB of its size and makes one memory reference per ms of CPU. The
+ * references of a CPU burst (the run between two I/O requests) stay within a window of working_set
+ * pages, which moves on by a whole window at the next burst, so every burst starts by faulting its new
+ * working set in. A reference goes to the TLB first (a few entries, flushed on every context switch),
+ * then to the page table; a page that isn't resident is a page fault, which takes the process through
+ * WAITING for page_fault_time ms like any other I/O, after a frame was found for the page. The
+ * restarted reference always succeeds, even if the page was evicted again while the process waited
+ * for the CPU, so a thrashing system still gets one ms of work done per fault instead of livelocking.
+ *
+ * Every structure is an array indexed by page or frame, so a reference, a fault and an eviction are
+ * O(1) under all three replacement policies:
+ *  - FIFO evicts the head of the frame list, pages join it at the tail when they are loaded,
+ *  - LRU is the same list, with a page moved to the tail whenever it is referenced,
+ *  - CLOCK sweeps a hand over the frames, giving referenced ones a second chance.
+ * The page table is a flat vector where the pages of process i start at first_page[i], so it plays
+ * the part of the hash map from (process, page) to frame without hashing.
+ */
+
+#ifndef PAGING_HPP_
+#define PAGING_HPP_
+
+#include <interrupts_AydanEng_EricCui.hpp>
+
+#include <climits>
+
+enum page_replacement
+{
+    REPLACE_FIFO,
+    REPLACE_LRU,
+    REPLACE_CLOCK
+};
+
+inline const char *replacement_name(page_replacement replacement)
+{
+    const char *names[] = {"fifo", "lru", "clock"};
+    return names[replacement];
+}
+
+// Marks a page that is not resident, a free frame and the ends of the frame list
+inline const uint32_t NO_FRAME = UINT32_MAX;
+
+struct paging_stats
+{
+    unsigned long long references = 0;
+    unsigned long long tlb_hits = 0;
+    unsigned long long page_faults = 0;
+    unsigned long long evictions = 0;
+};
+
+struct paged_memory
+{
+    // Page table: page_frame[first_page[process] + page] is the frame holding the page
+    std::vector<uint32_t> first_page; // one entry per process, plus the total page count
+    std::vector<uint32_t> page_frame;
+
+    // Frame table: the page in each frame (as a page table index) and the FIFO/LRU order
+    std::vector<uint32_t> frame_page;
+    std::vector<uint32_t> frame_prev;
+    std::vector<uint32_t> frame_next;
+    std::vector<uint8_t> frame_referenced; // CLOCK's reference bits
+    std::vector<uint32_t> free_frames;
+    uint32_t oldest;     // head of the frame list, the next FIFO/LRU victim
+    uint32_t newest;     // tail of the frame list
+    uint32_t clock_hand;
+
+    // TLB: page table indices of the running process's recent pages, replaced round robin
+    std::vector<uint32_t> tlb;
+    uint32_t tlb_next;
+
+    // Per process: the reference that faulted is retried and succeeds when the process next runs
+    std::vector<uint8_t> fault_served;
+
+    paging_stats stats;
+};
+
+// Page fault trap, costs nothing for the same reason as the other interrupts (see interrupts.md)
+inline std::pair<std::string, int> page_fault(int current_time, bool detailed = false)
+{
+    auto [execution, time] = intr_boilerplate(current_time, 14, 0, detailed, 4);
+    if (detailed)
+    {
+        append_isr_steps(execution, time, {{1, "obtain ISR address"}, {1, "find a frame for the page"}, {1, "start the page read"}, {1, "IRET"}});
+    }
+    return std::make_pair(execution, time);
+}
+
+// Sizes the page tables for processes (one page per MB, at least one) and empties frames and TLB
+inline void init_paged_memory(paged_memory &memory, const std::vector<PCB> &processes, unsigned int frames, unsigned int tlb_entries)
+{
+    memory.first_page.assign(1, 0);
+    memory.first_page.reserve(processes.size() + 1);
+    for (const auto &process : processes)
+    {
+        memory.first_page.push_back(memory.first_page.back() + std::max(process.size, 1u));
+    }
+    memory.page_frame.assign(memory.first_page.back(), NO_FRAME);
+
+    memory.frame_page.assign(frames, NO_FRAME);
+    memory.frame_prev.assign(frames, NO_FRAME);
+    memory.frame_next.assign(frames, NO_FRAME);
+    memory.frame_referenced.assign(frames, 0);
+    memory.free_frames.resize(frames);
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        memory.free_frames[i] = frames - 1 - i; // frame 0 is handed out first
+    }
+    memory.oldest = NO_FRAME;
+    memory.newest = NO_FRAME;
+    memory.clock_hand = 0;
+
+    memory.tlb.assign(tlb_entries, NO_FRAME);
+    memory.tlb_next = 0;
+    memory.fault_served.assign(processes.size(), 0);
+    memory.stats = paging_stats();
+}
+
+// Page table index of the page process references in its executed-th ms of CPU
+inline uint32_t referenced_page(const paged_memory &memory, const PCB &process, uint32_t index, unsigned int executed, unsigned int working_set)
+{
+    uint32_t pages = memory.first_page[index + 1] - memory.first_page[index];
+    uint32_t window = std::max(1u, std::min(working_set, pages));
+    uint32_t burst = (process.io_freq > 0) ? executed / process.io_freq : 0;
+
+    // mix of the PID and the time, so the reference stream is the same on every run
+    uint64_t mix = splitmix64((uint64_t)(uint32_t)process.PID << 32 | executed);
+
+    uint32_t page = (uint32_t)(((uint64_t)burst * window + mix % window) % pages);
+    return memory.first_page[index] + page;
+}
+
+inline void unlink_frame(paged_memory &memory, uint32_t frame)
+{
+    uint32_t prev = memory.frame_prev[frame];
+    uint32_t next = memory.frame_next[frame];
+    (prev == NO_FRAME ? memory.oldest : memory.frame_next[prev]) = next;
+    (next == NO_FRAME ? memory.newest : memory.frame_prev[next]) = prev;
+    memory.frame_prev[frame] = NO_FRAME;
+    memory.frame_next[frame] = NO_FRAME;
+}
+
+inline void append_frame(paged_memory &memory, uint32_t frame)
+{
+    memory.frame_prev[frame] = memory.newest;
+    memory.frame_next[frame] = NO_FRAME;
+    (memory.newest == NO_FRAME ? memory.oldest : memory.frame_next[memory.newest]) = frame;
+    memory.newest = frame;
+}
+
+inline void flush_tlb(paged_memory &memory)
+{
+    std::fill(memory.tlb.begin(), memory.tlb.end(), NO_FRAME);
+}
+
+// Looks page up in the TLB and the page table and updates the replacement state; false is a page fault
+inline bool reference_page(paged_memory &memory, page_replacement replacement, uint32_t page)
+{
+    memory.stats.references += 1;
+    if (std::find(memory.tlb.begin(), memory.tlb.end(), page) != memory.tlb.end())
+    {
+        memory.stats.tlb_hits += 1;
+    }
+    else if (memory.page_frame[page] == NO_FRAME)
+    {
+        memory.stats.page_faults += 1;
+        return false;
+    }
+    else if (!memory.tlb.empty())
+    {
+        memory.tlb[memory.tlb_next] = page;
+        memory.tlb_next = (memory.tlb_next + 1) % memory.tlb.size();
+    }
+
+    uint32_t frame = memory.page_frame[page];
+    if (replacement == REPLACE_LRU && frame != memory.newest)
+    {
+        unlink_frame(memory, frame);
+        append_frame(memory, frame);
+    }
+    memory.frame_referenced[frame] = 1;
+    return true;
+}
+
+// Frame to evict under the replacement policy; the pool must be full
+inline uint32_t choose_victim_frame(paged_memory &memory, page_replacement replacement)
+{
+    if (replacement != REPLACE_CLOCK)
+    {
+        return memory.oldest;
+    }
+    while (memory.frame_referenced[memory.clock_hand])
+    {
+        memory.frame_referenced[memory.clock_hand] = 0;
+        memory.clock_hand = (memory.clock_hand + 1) % memory.frame_page.size();
+    }
+    uint32_t frame = memory.clock_hand;
+    memory.clock_hand = (memory.clock_hand + 1) % memory.frame_page.size();
+    return frame;
+}
+
+// Maps page into a free frame, evicting one when the pool is full
+inline void load_page(paged_memory &memory, page_replacement replacement, uint32_t page)
+{
+    uint32_t frame;
+    if (!memory.free_frames.empty())
+    {
+        frame = memory.free_frames.back();
+        memory.free_frames.pop_back();
+    }
+    else
+    {
+        frame = choose_victim_frame(memory, replacement);
+        uint32_t evicted = memory.frame_page[frame];
+        memory.page_frame[evicted] = NO_FRAME;
+        std::replace(memory.tlb.begin(), memory.tlb.end(), evicted, NO_FRAME);
+        unlink_frame(memory, frame);
+        memory.stats.evictions += 1;
+    }
+
+    memory.frame_page[frame] = page;
+    memory.page_frame[page] = frame;
+    memory.frame_referenced[frame] = 1;
+    append_frame(memory, frame);
+}
+
+// Frees every resident page of a terminated process
+inline void release_pages(paged_memory &memory, uint32_t index)
+{
+    for (uint32_t page = memory.first_page[index]; page < memory.first_page[index + 1]; page++)
+    {
+        uint32_t frame = memory.page_frame[page];
+        if (frame == NO_FRAME)
+        {
+            continue;
+        }
+        memory.page_frame[page] = NO_FRAME;
+        memory.frame_page[frame] = NO_FRAME;
+        memory.frame_referenced[frame] = 0;
+        unlink_frame(memory, frame);
+        memory.free_frames.push_back(frame);
+    }
+    std::replace_if(memory.tlb.begin(), memory.tlb.end(), [&memory, index](uint32_t page)
+                    { return page != NO_FRAME && page >= memory.first_page[index] && page < memory.first_page[index + 1]; },
+                    NO_FRAME);
+}
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * @file phase_timers.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Compile-time optional timers around the phases of the simulation loop
+ *
+ * Build with -DSIM_PHASE_TIMERS=1 (cmake -DSIM_PHASE_TIMERS=ON) and every phase of Simulator::step()
+ * counts its calls and the queue entries it scanned, and is timed with the TSC (steady_clock off x86)
+ * on one step in SIM_PHASE_SAMPLE_EVERY (64 by default, 1 times every step); a phase's time is its
+ * mean sampled cost times its calls. Sampling keeps the clock reads, which cost as much as a whole
+ * idle step under some hypervisors, from swamping what is measured. The scheduler programs print the
+ * breakdown to stderr at exit. Without the flag the macros compile to nothing and the profile stays
+ * empty.
+ */
+
+#ifndef PHASE_TIMERS_HPP_
+#define PHASE_TIMERS_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef SIM_PHASE_TIMERS
+#define SIM_PHASE_TIMERS 0
+#endif
+
+#ifndef SIM_PHASE_SAMPLE_EVERY
+#define SIM_PHASE_SAMPLE_EVERY 64
+#endif
+
+enum sim_phase
+{
+    PHASE_ARRIVALS,      // admitting arrivals into memory
+    PHASE_WAIT_QUEUE,    // scanning the wait queue for finished I/O
+    PHASE_PREEMPT,       // quantum expiry and priority preemption
+    PHASE_DISPATCH,      // sorting the ready queue and dispatching
+    PHASE_EXECUTE,       // running the CPU for 1ms, termination and I/O requests
+    PHASE_MEMORY_WAKEUP, // admitting memory waiters after a termination (nested in PHASE_EXECUTE)
+    PHASE_COUNT
+};
+
+inline const char *phase_name(int phase)
+{
+    const char *names[] = {"arrivals", "wait queue", "preemption", "dispatch", "execution", "memory wakeups"};
+    return names[phase];
+}
+
+inline uint64_t phase_clock()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct phase_profile
+{
+    uint64_t ticks[PHASE_COUNT] = {};   // phase_clock() ticks over the sampled calls
+    uint64_t sampled[PHASE_COUNT] = {}; // calls that were timed
+    uint64_t calls[PHASE_COUNT] = {};
+    uint64_t items[PHASE_COUNT] = {}; // queue entries scanned or sorted
+
+    uint64_t steps = 0;
+    bool sampling = false; // whether the current step is timed
+
+    uint64_t clock_overhead = 0; // ticks measured by an empty timed scope, taken off every sample
+
+    // phase_clock() against wall time over the run, to turn ticks into seconds
+    uint64_t started_ticks = 0;
+    std::chrono::steady_clock::time_point started;
+    uint64_t finished_ticks = 0;
+    std::chrono::steady_clock::time_point finished;
+};
+
+inline void start_phase_profile(phase_profile &profile)
+{
+    profile = phase_profile();
+#if SIM_PHASE_TIMERS
+    // the cheapest of many back-to-back reads is the cost the timers add to each sample
+    profile.clock_overhead = UINT64_MAX;
+    for (int i = 0; i < 1000; i++)
+    {
+        uint64_t start = phase_clock();
+        profile.clock_overhead = std::min(profile.clock_overhead, phase_clock() - start);
+    }
+#endif
+    profile.started_ticks = phase_clock();
+    profile.started = std::chrono::steady_clock::now();
+}
+
+inline void finish_phase_profile(phase_profile &profile)
+{
+    profile.finished_ticks = phase_clock();
+    profile.finished = std::chrono::steady_clock::now();
+}
+
+// Counts a call of one phase and, on a sampled step, adds the lifetime of the scope to it
+class phase_timer
+{
+public:
+    phase_timer(phase_profile &profile, sim_phase phase)
+        : profile(profile), phase(phase), start(profile.sampling ? phase_clock() : 0) {}
+    ~phase_timer()
+    {
+        profile.calls[phase] += 1;
+        if (profile.sampling)
+        {
+            profile.ticks[phase] += phase_clock() - start;
+            profile.sampled[phase] += 1;
+        }
+    }
+
+private:
+    phase_profile &profile;
+    sim_phase phase;
+    uint64_t start;
+};
+
+#if SIM_PHASE_TIMERS
+#define SIM_PHASE_STEP(profile) ((profile).sampling = (++(profile).steps % SIM_PHASE_SAMPLE_EVERY) == 0)
+#define SIM_PHASE_TIMER(profile, phase) phase_timer phase_timer_scope((profile), (phase))
+#define SIM_PHASE_ITEMS(profile, phase, count) ((profile).items[(phase)] += (count))
+#else
+#define SIM_PHASE_STEP(profile) ((void)0)
+#define SIM_PHASE_TIMER(profile, phase) ((void)0)
+#define SIM_PHASE_ITEMS(profile, phase, count) ((void)0)
+#endif
+
+// Table of where the time went, execution excluding the memory wakeups nested in it
+inline std::string print_phase_profile(const phase_profile &profile, const char *scheduler)
+{
+    double wall = std::chrono::duration<double>(profile.finished - profile.started).count();
+    uint64_t run_ticks = profile.finished_ticks - profile.started_ticks;
+    double seconds_per_tick = (run_ticks > 0) ? wall / run_ticks : 0;
+
+    double estimated[PHASE_COUNT];
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        uint64_t sampled = std::max<uint64_t>(profile.sampled[phase], 1);
+        double ticks_per_call = std::max(0.0, (double)profile.ticks[phase] / sampled - profile.clock_overhead);
+        estimated[phase] = ticks_per_call * profile.calls[phase] * seconds_per_tick;
+    }
+    estimated[PHASE_EXECUTE] = std::max(0.0, estimated[PHASE_EXECUTE] - estimated[PHASE_MEMORY_WAKEUP]);
+
+    double total = 0;
+    for (double seconds : estimated)
+    {
+        total += seconds;
+    }
+
+    std::string report;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%s phase profile (%.3fs of simulation loop, %.3fs wall, 1 step in %d timed)\n",
+                  scheduler, total, wall, SIM_PHASE_SAMPLE_EVERY);
+    report += line;
+    std::snprintf(line, sizeof(line), "  %-15s %10s %7s %14s %14s %12s\n", "phase", "seconds", "share", "calls", "items", "ns/call");
+    report += line;
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        double seconds = estimated[phase];
+        std::snprintf(line, sizeof(line), "  %-15s %10.3f %6.1f%% %14llu %14llu %12.1f\n", phase_name(phase), seconds,
+                      (total > 0) ? 100.0 * seconds / total : 0.0,
+                      (unsigned long long)profile.calls[phase], (unsigned long long)profile.items[phase],
+                      (profile.calls[phase] > 0) ? seconds * 1e9 / profile.calls[phase] : 0.0);
+        report += line;
+    }
+    return report;
+}
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @file replay.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Replays a run against the wall clock, streaming its transitions as they happen
+ *
+ */
+
+#include <replay.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <csignal>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Connects a stream socket to "unix:PATH" or "tcp:HOST:PORT", -1 on failure
+static int connect_socket(const std::string &destination)
+{
+    if (destination.rfind("unix:", 0) == 0)
+    {
+        std::string path = destination.substr(5);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            return -1;
+        }
+        std::copy(path.begin(), path.end(), address.sun_path);
+
+        int socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socket_fd != -1 && connect(socket_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            close(socket_fd);
+            socket_fd = -1;
+        }
+        return socket_fd;
+    }
+
+    std::string host_port = destination.substr(4);
+    std::size_t colon = host_port.rfind(':');
+    if (colon == std::string::npos)
+    {
+        return -1;
+    }
+    addrinfo hints = {};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (getaddrinfo(host_port.substr(0, colon).c_str(), host_port.substr(colon + 1).c_str(), &hints, &addresses) != 0)
+    {
+        return -1;
+    }
+    int socket_fd = -1;
+    for (addrinfo *address = addresses; address != nullptr && socket_fd == -1; address = address->ai_next)
+    {
+        socket_fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (socket_fd != -1 && connect(socket_fd, address->ai_addr, address->ai_addrlen) != 0)
+        {
+            close(socket_fd);
+            socket_fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    return socket_fd;
+}
+
+replay_pacer::replay_pacer(const std::string &destination, double speed, unsigned int batch_ms)
+    : speed(speed)
+{
+    batch_time = (unsigned int)std::clamp(std::round(batch_ms * speed), 1.0, 1e9);
+    if (destination == "-")
+        output = dup(STDOUT_FILENO);
+    else if (destination.rfind("unix:", 0) == 0 || destination.rfind("tcp:", 0) == 0)
+        output = connect_socket(destination);
+    else
+        output = open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644); // a FIFO blocks until read
+
+    // A consumer that goes away shows up as a failed write, not as a signal
+    std::signal(SIGPIPE, SIG_IGN);
+    pending.reserve(1 << 16);
+}
+
+replay_pacer::~replay_pacer()
+{
+    if (output != -1)
+    {
+        close(output);
+    }
+}
+
+void replay_pacer::start(unsigned int start_time)
+{
+    this->start_time = start_time;
+    next_time = start_time + batch_time;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+}
+
+bool replay_pacer::pace(unsigned int time)
+{
+    // Wall time at which time is due
+    long long offset = (long long)std::llround((time - start_time) * 1e6 / speed); // ns
+    timespec deadline = started;
+    deadline.tv_sec += offset / 1000000000;
+    deadline.tv_nsec += offset % 1000000000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double lag = (now.tv_sec - deadline.tv_sec) * 1e3 + (now.tv_nsec - deadline.tv_nsec) / 1e6;
+    if (lag > 0)
+    {
+        max_lag = std::max(max_lag, lag);
+    }
+    else
+    {
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+        {
+        }
+    }
+
+    next_time = time + batch_time;
+    return write_pending();
+}
+
+void replay_pacer::on_transition(const sim_transition &transition)
+{
+    const char *state_names[] = {"NEW", "READY", "RUNNING", "WAITING", "TERMINATED", "NOT_ASSIGNED",
+                                 "SUSPENDED_READY", "SUSPENDED_WAITING"};
+    char line[96];
+    char *end = std::to_chars(line, line + 24, transition.time).ptr;
+    *end++ = ',';
+    end = std::to_chars(end, end + 24, transition.PID).ptr;
+    pending.append(line, end);
+    pending += ',';
+    pending += state_names[transition.old_state];
+    pending += ',';
+    pending += state_names[transition.new_state];
+    pending += '\n';
+    written += 1;
+}
+
+bool replay_pacer::write_pending()
+{
+    const char *data = pending.data();
+    std::size_t left = pending.size();
+    while (left > 0 && output != -1)
+    {
+        ssize_t done = write(output, data, left);
+        if (done < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (done <= 0)
+        {
+            close(output);
+            output = -1;
+            break;
+        }
+        data += done;
+        left -= done;
+    }
+    pending.clear();
+    return output != -1;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file replay.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Replays a run against the wall clock, streaming its transitions as they happen
+ *
+ * replay_pacer is a SimObserver that holds back the simulation so that simulated ms t happens
+ * t / speed wall ms after the start (speed 1 is real time, 10 ten times faster), and writes every
+ * transition as a "time,PID,old_state,new_state" line once its time has come. Pacing works in batches
+ * of batch_ms wall ms: the simulator runs ahead to the end of the batch (speed * batch_ms simulated
+ * ms), the pacer sleeps with clock_nanosleep(TIMER_ABSTIME) until that point is due and writes the
+ * batch's lines in one write(). That is two syscalls per batch however many ms or transitions it
+ * holds, and absolute deadlines keep sleep overshoot from adding up. A line is late by at most a batch.
+ * When the simulation can't keep up, the pacer doesn't sleep and records the lag instead.
+ *
+ * The lines go to a file or FIFO, "-" (stdout), "unix:PATH" (a UNIX stream socket) or "tcp:HOST:PORT".
+ */
+
+#ifndef REPLAY_HPP_
+#define REPLAY_HPP_
+
+#include <simulator.hpp>
+
+#include <ctime>
+
+class replay_pacer : public SimObserver
+{
+public:
+    replay_pacer(const std::string &destination, double speed, unsigned int batch_ms);
+    ~replay_pacer();
+
+    bool is_open() const { return output != -1; }
+
+    // Starts the wall clock, simulated time start_time is now
+    void start(unsigned int start_time);
+
+    // Simulated time the current batch ends at, the simulator should stop there
+    unsigned int batch_end() const { return next_time; }
+
+    // The simulator reached time: sleeps until it is due and writes the lines. Returns false once the
+    // destination stopped taking them.
+    bool pace(unsigned int time);
+
+    void on_transition(const sim_transition &transition) override;
+
+    unsigned long long lines() const { return written; }
+    double max_lag_ms() const { return max_lag; } // most a batch was behind its wall deadline
+
+private:
+    bool write_pending();
+
+    int output;
+    double speed;
+    unsigned int batch_time; // simulated ms per batch
+    unsigned int start_time = 0;
+    unsigned int next_time = 0;
+    timespec started = {};
+
+    std::string pending;
+    unsigned long long written = 0;
+    double max_lag = 0;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file sharded_run.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Runs one trace as independent shards on all cores (see shards.hpp)
+ *
+ * The shards are simulated in parallel and their tables merged in time order, so the output files are
+ * the same whatever the thread count. They are named like the scheduler programs' (execution<SCHED>.txt
+ * and fairness<SCHED>.csv).
+ *
+ * Usage: ./sharded_run <RR | EP | EP_RR> <input_file.txt | -> <shard_config> [aging_interval_ms] [threads]
+ */
+
+#include <shards.hpp>
+
+#include <chrono>
+#include <thread>
+
+int main(int argc, char **argv)
+{
+    if (argc < 4 || argc > 6)
+    {
+        std::cout << "Usage: ./sharded_run <RR | EP | EP_RR> <input_file.txt | -> <shard_config> [aging_interval_ms] [threads]" << std::endl;
+        return -1;
+    }
+
+    SimConfig config;
+    std::string name = argv[1];
+    if (name == "RR")
+        config.policy = ROUND_ROBIN;
+    else if (name == "EP")
+        config.policy = EXTERNAL_PRIORITY;
+    else if (name == "EP_RR")
+        config.policy = EXTERNAL_PRIORITY_RR;
+    else
+    {
+        std::cerr << "Error: unknown scheduler " << name << std::endl;
+        return -1;
+    }
+    config.aging_interval = (argc > 4) ? std::stoi(argv[4]) : 0;
+    unsigned int threads = (argc > 5) ? std::stoul(argv[5]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::ifstream shard_file(argv[3]);
+    if (!shard_file.is_open())
+    {
+        std::cerr << "Error: Unable to open file: " << argv[3] << std::endl;
+        return -1;
+    }
+    std::vector<shard_spec> shards;
+    std::string error;
+    if (!read_shard_config(shard_file, shards, error))
+    {
+        std::cerr << "Error: " << argv[3] << ", " << error << std::endl;
+        return -1;
+    }
+
+    std::string file_name = argv[2];
+    std::ifstream input_file;
+    std::istream *input = &std::cin;
+    if (file_name != "-")
+    {
+        input_file.open(file_name);
+        if (!input_file.is_open())
+        {
+            std::cerr << "Error: Unable to open file: " << file_name << std::endl;
+            return -1;
+        }
+        input = &input_file;
+    }
+    std::vector<burst_run> bursts;
+    std::vector<PCB> processes;
+    try
+    {
+        processes = read_processes(*input, bursts);
+    }
+    catch (const std::invalid_argument &error)
+    {
+        std::cerr << "Error: " << file_name << ", " << error.what() << std::endl;
+        return -1;
+    }
+
+    std::string execution_name = "execution" + name + ".txt";
+    std::ofstream execution_file(execution_name, std::ios::binary | std::ios::trunc);
+    if (!execution_file.is_open())
+    {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    SimResult result;
+    if (!run_shards(config, shards, processes, bursts, threads, execution_file, result, error))
+    {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << shards.size() << " shards on " << std::min<std::size_t>(threads, shards.size()) << " threads finished at "
+              << result.end_time << "ms, " << result.transitions << " transitions in " << seconds << "s" << std::endl;
+    std::cout << "Output generated in " << execution_name << std::endl;
+    write_output(result.fairness, ("fairness" + name + ".csv").c_str());
+    return 0;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file shards.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Simulates independent shards of one trace in parallel and merges their execution tables
+ *
+ */
+
+#include <shards.hpp>
+
+#include <atomic>
+#include <queue>
+#include <thread>
+
+// One execution table row, as the shard produced it
+struct shard_row
+{
+    unsigned int time;
+    int PID;
+    uint8_t old_state;
+    uint8_t new_state;
+};
+
+class shard_recorder : public SimObserver
+{
+public:
+    void on_transition(const sim_transition &transition) override
+    {
+        rows.push_back({transition.time, transition.PID, (uint8_t)transition.old_state, (uint8_t)transition.new_state});
+    }
+
+    std::vector<shard_row> rows;
+};
+
+struct shard_run
+{
+    std::vector<uint32_t> members; // indices into the whole trace, in input order
+    shard_recorder recorder;
+    SimResult result;
+};
+
+// Parses "a,b-c,..." into ranges; returns false on anything that is not a PID or a range
+static bool parse_PID_ranges(const std::string &list, std::vector<std::pair<int, int>> &ranges)
+{
+    std::stringstream items(list);
+    std::string item;
+    while (std::getline(items, item, ','))
+    {
+        std::size_t dash = item.find('-', 1);
+        std::string first = item.substr(0, dash);
+        std::string last = (dash == std::string::npos) ? first : item.substr(dash + 1);
+        if (first.empty() || last.empty() || first.find_first_not_of("0123456789") != std::string::npos ||
+            last.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        ranges.push_back({std::stoi(first), std::stoi(last)});
+    }
+    return !ranges.empty();
+}
+
+bool read_shard_config(std::istream &input, std::vector<shard_spec> &shards, std::string &error)
+{
+    std::string line;
+    for (int line_number = 1; std::getline(input, line); line_number++)
+    {
+        line = line.substr(0, line.find('#'));
+        std::stringstream fields(line);
+        std::string name, sizes, PIDs, extra;
+        if (!(fields >> name))
+        {
+            continue; // blank or comment
+        }
+
+        shard_spec shard;
+        shard.name = name;
+        bool valid = (bool)(fields >> sizes >> PIDs) && !(fields >> extra);
+
+        std::stringstream size_list(sizes);
+        std::string size;
+        while (valid && std::getline(size_list, size, ','))
+        {
+            valid = !size.empty() && size.find_first_not_of("0123456789") == std::string::npos;
+            if (valid)
+            {
+                shard.partitions.push_back({(unsigned int)shard.partitions.size() + 1, (unsigned int)std::stoul(size), -1});
+            }
+        }
+        valid = valid && !shard.partitions.empty();
+
+        if (valid && PIDs == "*")
+        {
+            shard.catch_all = true;
+        }
+        else
+        {
+            valid = valid && parse_PID_ranges(PIDs, shard.PID_ranges);
+        }
+
+        if (!valid)
+        {
+            error = "line " + std::to_string(line_number) + ": expected <name> <sizes,...> <PIDs,...|*>";
+            return false;
+        }
+        shards.push_back(shard);
+    }
+
+    if (shards.empty())
+    {
+        error = "no shards";
+        return false;
+    }
+    return true;
+}
+
+// Shard that runs PID: the first one listing it, else the catch-all, else -1
+static int find_shard(const std::vector<shard_spec> &shards, int PID)
+{
+    int catch_all = -1;
+    for (std::size_t i = 0; i < shards.size(); i++)
+    {
+        for (const auto &range : shards[i].PID_ranges)
+        {
+            if (PID >= range.first && PID <= range.second)
+            {
+                return i;
+            }
+        }
+        if (shards[i].catch_all && catch_all == -1)
+        {
+            catch_all = i;
+        }
+    }
+    return catch_all;
+}
+
+bool run_shards(const SimConfig &config, const std::vector<shard_spec> &shards, const std::vector<PCB> &processes,
+                const std::vector<burst_run> &bursts, unsigned int threads, std::ostream &execution, SimResult &result, std::string &error)
+{
+    std::vector<shard_run> runs(shards.size());
+    for (uint32_t i = 0; i < processes.size(); i++)
+    {
+        int shard = find_shard(shards, processes[i].PID);
+        if (shard == -1)
+        {
+            error = "PID " + std::to_string(processes[i].PID) + " is in no shard";
+            return false;
+        }
+        runs[shard].members.push_back(i);
+    }
+
+    // Each shard runs on whichever worker picks it up, which only changes when it is done
+    std::atomic<std::size_t> next_shard(0);
+    auto simulate = [&]()
+    {
+        for (std::size_t shard = next_shard++; shard < runs.size(); shard = next_shard++)
+        {
+            shard_run &run = runs[shard];
+            std::vector<PCB> members;
+            members.reserve(run.members.size());
+            for (uint32_t index : run.members)
+            {
+                members.push_back(processes[index]);
+            }
+
+            SimConfig shard_config = config;
+            shard_config.partitions = shards[shard].partitions;
+            shard_config.record_execution = false; // rows come from the recorder
+            shard_config.execution_output = nullptr;
+            shard_config.telemetry = nullptr;
+            shard_config.log = nullptr; // the shards would interleave on the sinks
+            shard_config.timeseries = nullptr;
+
+            Simulator simulator(shard_config);
+            simulator.add_observer(&run.recorder);
+            run.result = simulator.run(members, bursts);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < std::min<std::size_t>(std::max(threads, 1u), runs.size()); i++)
+    {
+        workers.emplace_back(simulate);
+    }
+    simulate();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    // k-way merge on (time, shard); each shard's rows are already in time order
+    std::vector<std::size_t> cursor(runs.size(), 0);
+    using head = std::pair<unsigned int, std::size_t>;
+    std::priority_queue<head, std::vector<head>, std::greater<head>> heads;
+    for (std::size_t shard = 0; shard < runs.size(); shard++)
+    {
+        if (!runs[shard].recorder.rows.empty())
+        {
+            heads.push({runs[shard].recorder.rows[0].time, shard});
+        }
+    }
+
+    std::string buffer = print_exec_header();
+    buffer.reserve((1 << 16) + 128);
+    while (!heads.empty())
+    {
+        std::size_t shard = heads.top().second;
+        heads.pop();
+        const std::vector<shard_row> &rows = runs[shard].recorder.rows;
+
+        // the shard keeps the lead while its rows are not later than the next shard's
+        unsigned int limit = heads.empty() ? UINT_MAX : heads.top().first;
+        bool before = heads.empty() || shard < heads.top().second;
+        std::size_t &row = cursor[shard];
+        while (row < rows.size() && (rows[row].time < limit || (rows[row].time == limit && before)))
+        {
+            append_exec_status(buffer, rows[row].time, rows[row].PID, (states)rows[row].old_state, (states)rows[row].new_state);
+            row += 1;
+            if (buffer.size() >= (1 << 16))
+            {
+                execution.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        if (row < rows.size())
+        {
+            heads.push({rows[row].time, shard});
+        }
+        else
+        {
+            std::vector<shard_row>().swap(runs[shard].recorder.rows);
+        }
+    }
+    buffer += print_exec_footer();
+    execution.write(buffer.data(), buffer.size());
+
+    // Put the shards' final PCBs back in input order for the fairness report
+    result = SimResult();
+    result.processes.resize(processes.size());
+    result.end_time = 0;
+    result.transitions = 0;
+    for (auto &run : runs)
+    {
+        for (std::size_t i = 0; i < run.members.size(); i++)
+        {
+            result.processes[run.members[i]] = run.result.processes[i];
+        }
+        result.end_time = std::max(result.end_time, run.result.end_time);
+        result.transitions += run.result.transitions;
+    }
+    result.fairness = print_fairness_report(result.processes, config.max_wait_alert);
+    return true;
+}
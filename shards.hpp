@@ -0,0 +1,43 @@
+/**
+ * @file shards.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Simulates independent shards of one trace in parallel and merges their execution tables
+ *
+ * A shard is a class of jobs with its own CPU and its own partition table (e.g. one tenant's memory
+ * pool), so nothing one shard does can change the schedule of another. run_shards() gives every
+ * shard its own Simulator on a pool of threads, keeps each shard's transitions in memory and then
+ * merges them into one execution table ordered by time, then by shard (in config order), then by the
+ * order within the shard. The output therefore depends only on the trace and the config, never on the
+ * threads. With a single shard that holds every PID and the default partitions, the output is the
+ * unsharded run's.
+ *
+ * Shard config, one shard per line, '#' starts a comment:
+ *     <name> <partition sizes in MB, comma-separated> <PIDs>
+ * where <PIDs> is a comma-separated list of PIDs and inclusive ranges ("1-500,900"), or "*" for every
+ * PID no other shard lists. Partitions are numbered from 1 in each shard.
+ */
+
+#ifndef SHARDS_HPP_
+#define SHARDS_HPP_
+
+#include <simulator.hpp>
+
+struct shard_spec
+{
+    std::string name;
+    std::vector<memory_partition> partitions;
+    std::vector<std::pair<int, int>> PID_ranges; // inclusive
+    bool catch_all = false;                      // "*": the PIDs no other shard lists
+};
+
+// Reads a shard config; on a malformed line returns false with the line number in error
+bool read_shard_config(std::istream &input, std::vector<shard_spec> &shards, std::string &error);
+
+// Runs the processes of each shard (their I/O profile runs in bursts) under config (its partitions
+// replaced by the shard's) on up to threads threads and writes the merged execution table to execution. The result has the fairness
+// report and the final PCBs of every process in input order, the time the last shard finished and
+// the total transitions. Returns false with a message in error when a PID matches no shard.
+bool run_shards(const SimConfig &config, const std::vector<shard_spec> &shards, const std::vector<PCB> &processes,
+                const std::vector<burst_run> &bursts, unsigned int threads, std::ostream &execution, SimResult &result, std::string &error);
+
+#endif
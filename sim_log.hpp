@@ -0,0 +1,71 @@
+/**
+ * @file sim_log.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Leveled output of the simulator, each level with its own sink
+ *
+ * The levels, from the least to the most verbose:
+ *  - summary:      the closing lines of a run and the fairness report
+ *  - transitions:  the execution table (execution<SCHED>.txt)
+ *  - kernel-steps: the ISR steps of every interrupt, in the "time, duration, activity" format of
+ *                  assignment 1
+ *  - memory:       the partition table after every admission (the bonus task)
+ *  - debug:        the scheduler's decisions (dispatches, preemptions, swap victims, page faults)
+ * A level is on when it has a sink. The scheduler programs' --log-level L turns on L and every level
+ * below it, and --log-to gives a level a sink of its own; without --log-level they keep their usual
+ * output (summary, transitions and memory).
+ *
+ * Build with -DSIM_LOG_MAX_LEVEL=<n> (cmake -DSIM_LOG_MAX_LEVEL=summary, ...) and the levels above n are
+ * compiled out: SIM_LOG_ON() is then a constant false for them, so the simulation loop neither tests
+ * nor formats anything for them. The default keeps every level.
+ */
+
+#ifndef SIM_LOG_HPP_
+#define SIM_LOG_HPP_
+
+#include <ostream>
+#include <string>
+
+enum log_level
+{
+    LOG_OFF,
+    LOG_SUMMARY,
+    LOG_TRANSITIONS,
+    LOG_KERNEL_STEPS,
+    LOG_MEMORY,
+    LOG_DEBUG,
+    LOG_LEVEL_COUNT
+};
+
+#ifndef SIM_LOG_MAX_LEVEL
+#define SIM_LOG_MAX_LEVEL 5 // LOG_DEBUG
+#endif
+
+inline const char *log_level_name(int level)
+{
+    const char *names[] = {"off", "summary", "transitions", "kernel-steps", "memory", "debug"};
+    return names[level];
+}
+
+// LOG_LEVEL_COUNT when name is not a level
+inline log_level parse_log_level(const std::string &name)
+{
+    for (int level = LOG_OFF; level < LOG_LEVEL_COUNT; level++)
+    {
+        if (name == log_level_name(level))
+        {
+            return (log_level)level;
+        }
+    }
+    return LOG_LEVEL_COUNT;
+}
+
+// Where each level goes, null for a level that is off. LOG_OFF never has a sink.
+struct sim_log
+{
+    std::ostream *sinks[LOG_LEVEL_COUNT] = {};
+};
+
+// Whether level is compiled in and has a sink in log (a sim_log pointer, may be null)
+#define SIM_LOG_ON(log, level) ((level) <= SIM_LOG_MAX_LEVEL && (log) != nullptr && (log)->sinks[(level)] != nullptr)
+
+#endif
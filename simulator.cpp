@@ -0,0 +1,958 @@
+/**
+ * @file simulator.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief The simulation loop shared by the RR, EP and EP_RR schedulers
+ *
+ */
+
+#include <simulator.hpp>
+#include <timeseries.hpp>
+
+#include <cassert>
+#include <cstdarg>
+
+// A debug line, formatted only when the debug level is on (see sim_log.hpp)
+#define SIM_DEBUG(...)                             \
+    do                                             \
+    {                                              \
+        if (SIM_LOG_ON(config.log, LOG_DEBUG))     \
+        {                                          \
+            log_debug(__VA_ARGS__);                \
+        }                                          \
+    } while (0)
+
+Simulator::Simulator(const SimConfig &config) : config(config)
+{
+    assert(config.time_quantum >= 1 && config.time_quantum <= MAX_TIME_QUANTUM);
+    if (SIM_LOG_MAX_LEVEL < LOG_TRANSITIONS)
+    {
+        this->config.record_execution = false; // the transitions level is compiled out
+    }
+    load({});
+}
+
+void Simulator::add_observer(SimObserver *observer)
+{
+    observers.push_back(observer);
+}
+
+SimResult Simulator::run(const std::vector<PCB> &processes, const std::vector<burst_run> &bursts)
+{
+    load(processes, bursts);
+    run_until(UINT_MAX, ULLONG_MAX);
+    return finish();
+}
+
+void Simulator::load(const std::vector<PCB> &processes, const std::vector<burst_run> &bursts,
+                     std::vector<uint32_t> order)
+{
+    table = build_process_table(processes);
+    this->bursts = bursts;
+    arrivals = (order.size() == processes.size()) ? std::move(order) : arrival_order(table);
+    next_arrival = 0;
+    terminated = 0;
+    free_slots.clear();
+
+    ready_queue.clear();
+    wait_queue.clear();
+    memory_wait_queue.clear();
+    arrived.clear();
+    swap_queue.clear();
+    suspended_queue.clear();
+
+    partitions = config.partitions;
+    for (auto &partition : partitions)
+    {
+        partition.occupied = -1;
+    }
+    partition_holder.assign(partitions.size(), NO_PROCESS);
+    partition_memory_used = 0;
+    partitions_used = 0;
+    memory = paged_memory();
+    if (config.frames > 0)
+    {
+        init_paged_memory(memory, processes, config.frames, config.tlb_entries);
+    }
+    dvfs = dvfs_state();
+    dvfs.stats.busy_ms.assign(config.dvfs.p_states.size(), 0);
+    dvfs.stats.idle_ms.assign(config.dvfs.c_states.size(), 0);
+    dvfs.stats.wakeups.assign(config.dvfs.c_states.size(), 0);
+
+    std::fill(std::begin(state_counts), std::end(state_counts), 0);
+    state_counts[NOT_ASSIGNED] = table.pcb.size();
+
+    current_time = 0;
+    running = NO_PROCESS;
+    stalled = false;
+    higher_priority_arrived = false;
+    admitted = false;
+
+    // make the output table (the header row)
+    execution_status.clear();
+    if (config.record_execution)
+    {
+        execution_status += print_exec_header();
+    }
+    reserve_run_state();
+    execution_offset = 0;
+    transitions = 0;
+    start_phase_profile(profile);
+    publish_partitions();
+    publish();
+}
+
+uint32_t Simulator::spawn(const PCB &process)
+{
+    uint32_t index;
+    if (!free_slots.empty())
+    {
+        index = free_slots.back();
+        free_slots.pop_back();
+        terminated -= 1;
+        state_counts[TERMINATED] -= 1;
+        table.pcb[index] = process;
+        table.remaining_time[index] = process.remaining_time;
+        table.time_since_io[index] = process.time_since_io;
+        table.time_slice_time[index] = process.time_slice_time;
+        table.io_return_time[index] = process.io_return_time;
+        table.state[index] = process.state;
+    }
+    else
+    {
+        index = table.pcb.size();
+        table.pcb.push_back(process);
+        table.remaining_time.push_back(process.remaining_time);
+        table.time_since_io.push_back(process.time_since_io);
+        table.time_slice_time.push_back(process.time_slice_time);
+        table.io_return_time.push_back(process.io_return_time);
+        table.state.push_back(process.state);
+    }
+    state_counts[process.state] += 1;
+
+    // Arrivals that already happened are dropped first, so the list only holds pending ones
+    if (next_arrival == arrivals.size())
+    {
+        arrivals.clear();
+        next_arrival = 0;
+    }
+    auto position = std::upper_bound(arrivals.begin() + next_arrival, arrivals.end(), process.arrival_time,
+                                     [this](unsigned int time, uint32_t other)
+                                     { return time < table.pcb[other].arrival_time; });
+    arrivals.insert(position, index);
+    stalled = false;
+    return index;
+}
+
+sim_load Simulator::current_load() const
+{
+    sim_load load;
+    load.cpu_busy = (running != NO_PROCESS);
+    load.ready = ready_queue.size();
+    load.waiting = state_counts[WAITING];
+    load.memory_waiting = memory_wait_queue.size();
+    load.suspended = state_counts[SUSPENDED_READY] + state_counts[SUSPENDED_WAITING];
+    if (config.frames > 0)
+    {
+        load.memory_used = memory.frame_page.size() - memory.free_frames.size();
+        load.memory_units = load.memory_used;
+    }
+    else
+    {
+        load.memory_used = partition_memory_used;
+        load.memory_units = partitions_used;
+    }
+    return load;
+}
+
+bool Simulator::finished() const
+{
+    return terminated == table.pcb.size();
+}
+
+// One iteration of the simulation loop: admit, manage the wait queue, schedule, run for 1ms
+void Simulator::step()
+{
+    SIM_PHASE_STEP(profile);
+    if (!admitted)
+    {
+        higher_priority_arrived = false;
+        admit_arrivals();
+        manage_wait_queue();
+        if (!swap_queue.empty())
+        {
+            complete_swaps();
+        }
+    }
+    admitted = false;
+
+    preempt();
+    dispatch();
+    if (config.timeseries != nullptr)
+    {
+        config.timeseries->sample(current_time, current_load());
+    }
+    execute();
+
+    // A step takes nanoseconds, so the telemetry is refreshed every 64 steps
+    unpublished_steps += 1;
+    if (unpublished_steps == 64)
+    {
+        publish();
+    }
+}
+
+unsigned long long Simulator::run_until(unsigned int end_time, unsigned long long max_steps)
+{
+    unsigned long long steps = 0;
+    while (!finished() && !stalled && current_time < end_time && steps < max_steps)
+    {
+        step();
+        steps += 1;
+    }
+    return steps;
+}
+
+SimResult Simulator::finish()
+{
+    SimResult result;
+
+    // Close the output table
+    if (config.record_execution)
+    {
+        execution_status += print_exec_footer();
+    }
+    if (config.execution_output != nullptr)
+    {
+        flush_execution();
+    }
+    result.execution = std::move(execution_status);
+    result.processes = table_snapshot(table);
+    result.fairness = print_fairness_report(result.processes, config.max_wait_alert);
+    result.end_time = current_time;
+    result.transitions = transitions;
+    finish_phase_profile(profile);
+    result.profile = profile;
+    if (config.timeseries != nullptr)
+    {
+        config.timeseries->finish(current_time);
+    }
+    result.paging = memory.stats;
+    if (config.dvfs.governor != GOVERNOR_OFF)
+    {
+        // the CPU idled from its last busy ms to the end
+        charge_idle(config.dvfs, current_time - dvfs.busy_until, dvfs.stats);
+        dvfs.busy_until = current_time;
+        dvfs.stats.energy = 0;
+        for (std::size_t state = 0; state < config.dvfs.p_states.size(); state++)
+        {
+            dvfs.stats.energy += dvfs.stats.busy_ms[state] * config.dvfs.p_states[state].power;
+        }
+        for (std::size_t state = 0; state < config.dvfs.c_states.size(); state++)
+        {
+            dvfs.stats.energy += dvfs.stats.idle_ms[state] * config.dvfs.c_states[state].power;
+        }
+        result.energy = dvfs.stats;
+    }
+    if (stalled)
+    {
+        result.stuck = memory_wait_queue;
+        result.stuck.insert(result.stuck.end(), suspended_queue.begin(), suspended_queue.end());
+        std::sort(result.stuck.begin(), result.stuck.end());
+    }
+
+    // the run is over, hand its queues back in one go
+    std::vector<uint32_t>().swap(ready_queue);
+    std::vector<uint32_t>().swap(wait_queue);
+    std::vector<uint32_t>().swap(memory_wait_queue);
+    std::vector<uint32_t>().swap(arrived);
+    std::vector<uint32_t>().swap(swap_queue);
+    std::vector<uint32_t>().swap(suspended_queue);
+    publish();
+    if (config.telemetry != nullptr)
+    {
+        config.telemetry->finished.store(true, std::memory_order_relaxed);
+    }
+
+    for (SimObserver *observer : observers)
+    {
+        observer->on_finish(result);
+    }
+    return result;
+}
+
+bool Simulator::run_shared_prefix()
+{
+    while (!finished() && !stuck())
+    {
+        if (!admitted)
+        {
+            higher_priority_arrived = false;
+            admit_arrivals();
+            manage_wait_queue();
+            complete_swaps();
+            admitted = true;
+        }
+        if (policy_sensitive())
+        {
+            return true;
+        }
+        step();
+    }
+    return false;
+}
+
+Simulator Simulator::fork(const SimConfig &variant) const
+{
+    assert(variant.time_quantum >= 1 && variant.time_quantum <= MAX_TIME_QUANTUM);
+    Simulator child(*this);
+    child.config = variant;
+    child.config.partitions = config.partitions;
+    child.config.dvfs = config.dvfs; // the energy counters are per P-state and C-state
+    child.observers.clear();
+    child.reserve_run_state(); // copies only get the capacity they hold
+    return child;
+}
+
+// Every queue holds each process at most once, so sizing them from the trace up front means the
+// loop never allocates: the memory is taken once per run and released by finish(). The execution
+// text gets its whole flush chunk when it is streamed (it grows geometrically when it is kept).
+void Simulator::reserve_run_state()
+{
+    std::size_t processes = table.pcb.size();
+    ready_queue.reserve(processes);
+    wait_queue.reserve(processes);
+    memory_wait_queue.reserve(processes);
+    arrived.reserve(processes);
+    swap_queue.reserve(processes);
+    suspended_queue.reserve(processes);
+    if (config.execution_output != nullptr)
+    {
+        execution_status.reserve((1 << 16) + 128);
+    }
+}
+
+// Whether the rest of the current step (preempt, dispatch) could go differently under another policy
+bool Simulator::policy_sensitive() const
+{
+    if (running == NO_PROCESS)
+    {
+        return ready_queue.size() > 1;
+    }
+    return higher_priority_arrived || (table.time_slice_time[running] >= config.time_quantum && !ready_queue.empty());
+}
+
+void Simulator::admit_arrivals()
+{
+    SIM_PHASE_TIMER(profile, PHASE_ARRIVALS);
+    collect_arrivals(table, arrivals, next_arrival, current_time, arrived);
+    SIM_PHASE_ITEMS(profile, PHASE_ARRIVALS, arrived.size());
+    bool memory_wait = false;
+    for (uint32_t process : arrived)
+    {
+        // a process stays NEW until it gets a partition
+        state_counts[table.state[process]] -= 1;
+        state_counts[NEW] += 1;
+        change_state(table, process, NEW, current_time);
+        if (allocate(process))
+        {
+            ready_queue.push_back(process);
+            transition(process, READY);
+            check_priority(process);
+        }
+        else if (!swap_out_for(process))
+        {
+            SIM_DEBUG("PID %d waits for %uMB of memory", table.pcb[process].PID, table.pcb[process].size);
+            memory_wait_queue.push_back(process);
+            memory_wait = true;
+        }
+    }
+
+    // only once every arrival of this ms is in, a later one may still get a partition
+    if (memory_wait)
+    {
+        stalled = no_progress_possible();
+    }
+}
+
+void Simulator::manage_wait_queue()
+{
+    SIM_PHASE_TIMER(profile, PHASE_WAIT_QUEUE);
+    SIM_PHASE_ITEMS(profile, PHASE_WAIT_QUEUE, wait_queue.size());
+    auto wait_iterator = wait_queue.begin();
+    while (wait_iterator != wait_queue.end())
+    {
+        uint32_t process = *wait_iterator;
+        if (table.io_return_time[process] <= current_time)
+        {
+            auto [log, new_time] = end_io(current_time, SIM_LOG_ON(config.log, LOG_KERNEL_STEPS));
+            current_time = new_time;
+            log_kernel_steps(log);
+
+            wait_iterator = wait_queue.erase(wait_iterator);
+            if (table.state[process] == SUSPENDED_WAITING)
+            {
+                // the I/O finished on the backing store, the process still needs memory
+                transition(process, SUSPENDED_READY);
+                swap_in(process);
+                continue;
+            }
+            ready_queue.push_back(process);
+            transition(process, READY);
+            check_priority(process);
+        }
+        else
+        {
+            wait_iterator += 1;
+        }
+    }
+}
+
+// RR and EP_RR take the CPU back when the quantum expires and someone else is ready, EP_RR also when a
+// higher priority process became ready (see preemption.md); EP never preempts. A process running alone
+// gets a new slice under every policy, so the slice stays policy independent until someone waits.
+void Simulator::preempt()
+{
+    SIM_PHASE_TIMER(profile, PHASE_PREEMPT);
+    if (running == NO_PROCESS)
+    {
+        return;
+    }
+
+    bool preempt = (config.policy == EXTERNAL_PRIORITY_RR && higher_priority_arrived);
+    if (!preempt && table.time_slice_time[running] >= config.time_quantum)
+    {
+        if (!ready_queue.empty())
+        {
+            preempt = (config.policy != EXTERNAL_PRIORITY);
+        }
+        else
+        {
+            // new time slice since process is alone
+            table.time_slice_time[running] = 0;
+        }
+    }
+
+    if (preempt)
+    {
+        SIM_DEBUG("PID %d preempted: %s", table.pcb[running].PID,
+                  (table.time_slice_time[running] >= config.time_quantum) ? "quantum expired" : "higher priority ready");
+        auto [log, new_time] = context_switch(current_time, SIM_LOG_ON(config.log, LOG_KERNEL_STEPS));
+        current_time = new_time;
+        log_kernel_steps(log);
+
+        ready_queue.push_back(running);
+        transition(running, READY);
+        running = NO_PROCESS;
+    }
+}
+
+void Simulator::dispatch()
+{
+    SIM_PHASE_TIMER(profile, PHASE_DISPATCH);
+    if (running != NO_PROCESS || ready_queue.empty())
+    {
+        return;
+    }
+
+    if (config.policy != ROUND_ROBIN)
+    {
+        SIM_PHASE_ITEMS(profile, PHASE_DISPATCH, ready_queue.size());
+        sort_by_priority();
+    }
+
+    auto [log, new_time] = context_switch(current_time, SIM_LOG_ON(config.log, LOG_KERNEL_STEPS));
+    current_time = new_time;
+    log_kernel_steps(log);
+
+    running = ready_queue.front();
+    ready_queue.erase(ready_queue.begin());
+    SIM_DEBUG("dispatch PID %d, %zu more ready", table.pcb[running].PID, ready_queue.size());
+    transition(running, RUNNING);
+    table.time_slice_time[running] = 0; // Ensure quantum starts at 0
+    if (config.frames > 0)
+    {
+        flush_tlb(memory); // the TLB holds no address space tags
+    }
+    if (config.dvfs.governor != GOVERNOR_OFF)
+    {
+        wake_cpu();
+    }
+}
+
+void Simulator::execute()
+{
+    SIM_PHASE_TIMER(profile, PHASE_EXECUTE);
+    current_time += 1;
+    if (running == NO_PROCESS)
+    {
+        return;
+    }
+
+    // Frequency scaling: below the fastest P-state, some ms don't add up to a whole ms of work
+    if (config.dvfs.governor != GOVERNOR_OFF && !scaled_work_done())
+    {
+        table.time_slice_time[running] += 1;
+        return;
+    }
+
+    // Paged memory: the ms starts with a memory reference, and a page fault gives up the CPU to wait
+    // for the page like for any other I/O
+    if (config.frames > 0 && memory.fault_served[running])
+    {
+        memory.fault_served[running] = 0;
+    }
+    else if (config.frames > 0)
+    {
+        const PCB &program = table.pcb[running];
+        unsigned int executed = program.processing_time - table.remaining_time[running];
+        uint32_t page = referenced_page(memory, program, running, executed, config.working_set);
+        if (!reference_page(memory, config.replacement, page))
+        {
+            auto [log, new_time] = page_fault(current_time, SIM_LOG_ON(config.log, LOG_KERNEL_STEPS));
+            current_time = new_time;
+            log_kernel_steps(log);
+            SIM_DEBUG("PID %d faults on page %u", program.PID, page - memory.first_page[running]);
+
+            load_page(memory, config.replacement, page);
+            memory.fault_served[running] = 1;
+            table.io_return_time[running] = current_time + config.page_fault_time;
+            wait_queue.push_back(running);
+            transition(running, WAITING);
+            running = NO_PROCESS;
+            return;
+        }
+    }
+
+    table.remaining_time[running] -= 1;
+    table.time_since_io[running] += 1;
+    table.time_slice_time[running] += 1;
+
+    // termination
+    if (table.remaining_time[running] == 0)
+    {
+        SIM_DEBUG("PID %d terminated, turnaround %ums", table.pcb[running].PID, current_time - table.pcb[running].arrival_time);
+        transition(running, TERMINATED);
+        terminated += 1;
+        release(running);
+        if (config.recycle_terminated)
+        {
+            free_slots.push_back(running);
+        }
+        running = NO_PROCESS;
+
+        admit_memory_waiters();
+        stalled = no_progress_possible();
+    }
+
+    // IO Request
+    else if (table.pcb[running].io_freq > 0 && table.time_since_io[running] >= table.pcb[running].io_freq)
+    {
+        auto [log, new_time] = system_call(current_time, SIM_LOG_ON(config.log, LOG_KERNEL_STEPS));
+        current_time = new_time;
+        log_kernel_steps(log);
+
+        table.io_return_time[running] = current_time + table.pcb[running].io_duration;
+        table.time_since_io[running] = 0;
+        if (table.pcb[running].burst_first != table.pcb[running].burst_end)
+        {
+            advance_burst(table.pcb[running], bursts);
+        }
+        wait_queue.push_back(running);
+        transition(running, WAITING);
+        running = NO_PROCESS;
+    }
+}
+
+// One busy ms under frequency scaling: lets the governor decide when it is time, charges the ms to the
+// P-state and returns whether the work credit made up a whole ms of work
+bool Simulator::scaled_work_done()
+{
+    const dvfs_config &scaling = config.dvfs;
+    if (current_time >= dvfs.next_decision)
+    {
+        switch_p_state(select_p_state(scaling, dvfs.p_state, ready_queue.size()));
+        dvfs.next_decision = current_time + scaling.interval;
+    }
+    dvfs.stats.busy_ms[dvfs.p_state] += 1;
+    dvfs.busy_until = current_time;
+
+    dvfs.work_credit += scaling.p_states[dvfs.p_state].speed;
+    if (dvfs.work_credit < 1000)
+    {
+        return false;
+    }
+    dvfs.work_credit -= 1000;
+    return true;
+}
+
+// A process was dispatched: charges the idle period that ends here to the C-states, stalls for the
+// exit latency of the one the CPU got to and lets the governor pick the P-state for the new queue
+void Simulator::wake_cpu()
+{
+    const dvfs_config &scaling = config.dvfs;
+    switch_p_state(select_p_state(scaling, dvfs.p_state, ready_queue.size()));
+    dvfs.next_decision = current_time + scaling.interval;
+    if (current_time > dvfs.busy_until)
+    {
+        uint32_t reached = charge_idle(scaling, current_time - dvfs.busy_until, dvfs.stats);
+        dvfs.stats.wakeups[reached] += 1;
+        dvfs.work_credit -= (int64_t)scaling.c_states[reached].exit_latency * scaling.p_states[dvfs.p_state].speed / 1000;
+        dvfs.busy_until = current_time;
+    }
+}
+
+// Moves the CPU to another P-state, which stalls it for the switch latency
+void Simulator::switch_p_state(uint32_t state)
+{
+    if (state == dvfs.p_state)
+    {
+        return;
+    }
+    dvfs.p_state = state;
+    dvfs.stats.switches += 1;
+    dvfs.work_credit -= (int64_t)config.dvfs.switch_latency * config.dvfs.p_states[state].speed / 1000;
+}
+
+// A partition was freed, so swap in the suspended processes that fit, then admit whoever fits now,
+// in the order they were suspended or arrived
+void Simulator::admit_memory_waiters()
+{
+    SIM_PHASE_TIMER(profile, PHASE_MEMORY_WAKEUP);
+    SIM_PHASE_ITEMS(profile, PHASE_MEMORY_WAKEUP, suspended_queue.size() + memory_wait_queue.size());
+    auto suspended_it = suspended_queue.begin();
+    while (suspended_it != suspended_queue.end())
+    {
+        uint32_t process = *suspended_it;
+        if (allocate(process))
+        {
+            table.io_return_time[process] = current_time + config.swap_in_time;
+            swap_queue.push_back(process);
+            suspended_it = suspended_queue.erase(suspended_it);
+        }
+        else
+        {
+            suspended_it += 1;
+        }
+    }
+
+    auto mem_it = memory_wait_queue.begin();
+    while (mem_it != memory_wait_queue.end())
+    {
+        uint32_t process = *mem_it;
+        if (allocate(process))
+        {
+            ready_queue.push_back(process);
+            transition(process, READY);
+            mem_it = memory_wait_queue.erase(mem_it);
+        }
+        else if (swap_out_for(process))
+        {
+            mem_it = memory_wait_queue.erase(mem_it);
+        }
+        else
+        {
+            mem_it += 1;
+        }
+    }
+}
+
+// Swap transfers that are done: the newcomer a victim was written out for, or a suspended process that
+// was read back in, becomes READY
+void Simulator::complete_swaps()
+{
+    auto swap_it = swap_queue.begin();
+    while (swap_it != swap_queue.end())
+    {
+        uint32_t process = *swap_it;
+        if (table.io_return_time[process] <= current_time)
+        {
+            ready_queue.push_back(process);
+            transition(process, READY);
+            check_priority(process);
+            swap_it = swap_queue.erase(swap_it);
+        }
+        else
+        {
+            swap_it += 1;
+        }
+    }
+}
+
+// Moves a process to new_state, adding its row to the execution table and notifying the observers
+void Simulator::transition(uint32_t process, states new_state)
+{
+    states old_state = (states)table.state[process];
+    unsigned int since = table.pcb[process].state_entered;
+    change_state(table, process, new_state, current_time);
+    transitions += 1;
+    state_counts[old_state] -= 1;
+    state_counts[new_state] += 1;
+
+    if (LOG_TRANSITIONS <= SIM_LOG_MAX_LEVEL && config.record_execution)
+    {
+        append_exec_status(execution_status, current_time, table.pcb[process].PID, old_state, new_state);
+        if (config.execution_output != nullptr && execution_status.size() >= (1 << 16))
+        {
+            flush_execution();
+        }
+    }
+    if (!observers.empty())
+    {
+        sim_transition event = {current_time, process, table.pcb[process].PID, old_state, new_state, since};
+        for (SimObserver *observer : observers)
+        {
+            observer->on_transition(event);
+        }
+    }
+}
+
+void Simulator::log_kernel_steps(const std::string &steps)
+{
+    if (SIM_LOG_ON(config.log, LOG_KERNEL_STEPS))
+    {
+        *config.log->sinks[LOG_KERNEL_STEPS] << steps;
+    }
+}
+
+void Simulator::log_debug(const char *format, ...)
+{
+    char line[256];
+    int length = std::snprintf(line, sizeof(line), "%u, debug, ", current_time);
+    va_list arguments;
+    va_start(arguments, format);
+    std::vsnprintf(line + length, sizeof(line) - length, format, arguments);
+    va_end(arguments);
+    *config.log->sinks[LOG_DEBUG] << line << '\n';
+}
+
+void Simulator::flush_execution()
+{
+    config.execution_output->write(execution_status.data(), execution_status.size());
+    execution_offset += execution_status.size();
+    execution_status.clear();
+}
+
+// Copies the counters to the telemetry block, if there is one
+void Simulator::publish()
+{
+    unpublished_steps = 0;
+    sim_telemetry *telemetry = config.telemetry;
+    if (telemetry == nullptr)
+    {
+        return;
+    }
+
+    telemetry->time.store(current_time, std::memory_order_relaxed);
+    telemetry->transitions.store(transitions, std::memory_order_relaxed);
+    telemetry->ready.store(ready_queue.size(), std::memory_order_relaxed);
+    telemetry->waiting.store(wait_queue.size(), std::memory_order_relaxed);
+    telemetry->memory_waiting.store(memory_wait_queue.size(), std::memory_order_relaxed);
+    for (int state = 0; state < STATE_COUNT; state++)
+    {
+        telemetry->in_state[state].store(state_counts[state], std::memory_order_relaxed);
+    }
+}
+
+void Simulator::publish_partitions()
+{
+    if (config.telemetry == nullptr)
+    {
+        return;
+    }
+    config.telemetry->finished.store(false, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < partitions.size(); i++)
+    {
+        config.telemetry->partition_occupant[i].store(partitions[i].occupied, std::memory_order_relaxed);
+    }
+}
+
+bool Simulator::allocate(uint32_t process)
+{
+    if (config.frames > 0)
+    {
+        return true; // pages are faulted in as they are referenced
+    }
+
+    PCB &program = table.pcb[process];
+    if (!assign_memory(partitions, program))
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < partitions.size(); i++)
+    {
+        if (partitions[i].partition_number == (unsigned int)program.partition_number)
+        {
+            partition_holder[i] = process;
+            partition_memory_used += partitions[i].size;
+            partitions_used += 1;
+        }
+    }
+
+    if (SIM_LOG_ON(config.log, LOG_MEMORY))
+    {
+        print_memory_usage(partitions, current_time, *config.log->sinks[LOG_MEMORY]);
+    }
+    notify_partition(program.partition_number);
+    return true;
+}
+
+void Simulator::release(uint32_t process)
+{
+    if (config.frames > 0)
+    {
+        release_pages(memory, process);
+        return;
+    }
+
+    // Found by holder rather than by PID (as free_memory() does), two processes with the same PID can't
+    // free each other's partition
+    PCB &program = table.pcb[process];
+    int partition_number = program.partition_number;
+    auto holder = std::find(partition_holder.begin(), partition_holder.end(), process);
+    if (holder == partition_holder.end())
+    {
+        return;
+    }
+    std::size_t i = holder - partition_holder.begin();
+    partitions[i].occupied = -1;
+    program.partition_number = -1;
+    partition_holder[i] = NO_PROCESS;
+    partition_memory_used -= partitions[i].size;
+    partitions_used -= 1;
+
+    notify_partition(partition_number);
+}
+
+// Medium-term scheduler: makes room for process, which fits in no free partition, by suspending a
+// process from a partition it fits in. Only the partition holders can be victims, so the search is
+// over the partition table (a handful of entries) rather than the queues. A victim must be READY or
+// WAITING and have a worse (higher) base priority than process; WAITING holders go first since they
+// can't use the CPU anyway, then the worst priority, then the smallest partition. process keeps its
+// new partition and waits in swap_queue while the victim is written out. Returns false when there is
+// no victim (or swapping is off).
+bool Simulator::swap_out_for(uint32_t process)
+{
+    if (!config.swapping)
+    {
+        return false;
+    }
+
+    const PCB &program = table.pcb[process];
+    int victim_slot = -1;
+    for (std::size_t i = 0; i < partitions.size(); i++)
+    {
+        uint32_t holder = partition_holder[i];
+        if (holder == NO_PROCESS || partitions[i].size < program.size ||
+            (table.state[holder] != READY && table.state[holder] != WAITING) ||
+            table.pcb[holder].priority <= program.priority)
+        {
+            continue;
+        }
+        if (victim_slot == -1)
+        {
+            victim_slot = i;
+            continue;
+        }
+
+        uint32_t best = partition_holder[victim_slot];
+        bool waiting = table.state[holder] == WAITING;
+        bool best_waiting = table.state[best] == WAITING;
+        if (waiting != best_waiting)
+        {
+            victim_slot = waiting ? i : victim_slot;
+        }
+        else if (table.pcb[holder].priority != table.pcb[best].priority)
+        {
+            victim_slot = (table.pcb[holder].priority > table.pcb[best].priority) ? i : victim_slot;
+        }
+        else if (partitions[i].size < partitions[victim_slot].size)
+        {
+            victim_slot = i;
+        }
+    }
+    if (victim_slot == -1)
+    {
+        return false;
+    }
+
+    uint32_t victim = partition_holder[victim_slot];
+    SIM_DEBUG("PID %d suspended to make room for PID %d", table.pcb[victim].PID, program.PID);
+    if (table.state[victim] == READY)
+    {
+        ready_queue.erase(std::find(ready_queue.begin(), ready_queue.end(), victim));
+        transition(victim, SUSPENDED_READY);
+        suspended_queue.push_back(victim);
+    }
+    else
+    {
+        transition(victim, SUSPENDED_WAITING); // stays in wait_queue until its I/O is done
+    }
+    table.pcb[victim].swap_outs += 1;
+    release(victim);
+
+    allocate(process); // the freed partition is the only free one it fits in
+    table.io_return_time[process] = current_time + config.swap_out_time;
+    swap_queue.push_back(process);
+    return true;
+}
+
+// A suspended process whose I/O is done: read it back in if a partition is free, else queue it
+void Simulator::swap_in(uint32_t process)
+{
+    if (allocate(process))
+    {
+        table.io_return_time[process] = current_time + config.swap_in_time;
+        swap_queue.push_back(process);
+    }
+    else
+    {
+        suspended_queue.push_back(process);
+    }
+}
+
+// Tells the observers and the telemetry that a partition changed hands
+void Simulator::notify_partition(int partition_number)
+{
+    for (std::size_t i = 0; i < partitions.size(); i++)
+    {
+        if (partitions[i].partition_number != (unsigned int)partition_number)
+        {
+            continue;
+        }
+        if (config.telemetry != nullptr)
+        {
+            config.telemetry->partition_occupant[i].store(partitions[i].occupied, std::memory_order_relaxed);
+        }
+        for (SimObserver *observer : observers)
+        {
+            observer->on_partition(current_time, partitions[i]);
+        }
+    }
+}
+
+// EP_RR preempts when a process with a better (lower) base priority than the running one becomes ready
+void Simulator::check_priority(uint32_t process)
+{
+    if (running != NO_PROCESS && table.pcb[process].priority < table.pcb[running].priority)
+    {
+        higher_priority_arrived = true;
+    }
+}
+
+// Helper method to sort processes by priority in descending order (highest -> lowest prio)
+// Ties (same priority class) go to whoever has been READY the longest, then to the lower PID
+void Simulator::sort_by_priority()
+{
+    const process_table &table = this->table;
+    unsigned int current_time = this->current_time;
+    unsigned int aging_interval = config.aging_interval;
+    std::sort(ready_queue.begin(), ready_queue.end(), [&table, current_time, aging_interval](uint32_t a, uint32_t b)
+              {
+                  int a_priority = effective_priority(table, a, current_time, aging_interval);
+                  int b_priority = effective_priority(table, b, current_time, aging_interval);
+                  if (a_priority != b_priority)
+                      return a_priority < b_priority;
+                  if (table.pcb[a].ready_since != table.pcb[b].ready_since)
+                      return table.pcb[a].ready_since < table.pcb[b].ready_since;
+                  return table.pcb[a].PID < table.pcb[b].PID; });
+}
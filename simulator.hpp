@@ -0,0 +1,453 @@
+/**
+ * @file simulator.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Embeddable scheduling simulator: Simulator, SimConfig, SimResult and the observer interface
+ *
+ * One engine runs all three schedulers (RR, EP and EP_RR), picked with SimConfig::policy. A run can be
+ * done in one call (Simulator::run) or stepped one loop iteration at a time, and SimObserver callbacks
+ * receive every transition in memory, so tools don't have to format or parse the execution table.
+ */
+
+#ifndef SIMULATOR_HPP_
+#define SIMULATOR_HPP_
+
+#include <energy.hpp>
+#include <interrupts_AydanEng_EricCui.hpp>
+#include <paging.hpp>
+#include <phase_timers.hpp>
+#include <sim_log.hpp>
+
+#include <atomic>
+#include <climits>
+
+//------------------------------------PROCESS TABLE FOR THE SIMULATION LOOP-------------------------------
+
+// Marks an idle CPU in the index-based simulation loop
+inline const uint32_t NO_PROCESS = UINT32_MAX;
+
+// Longest time quantum, time_slice_time counts up to it in 16 bits
+inline const unsigned int MAX_TIME_QUANTUM = UINT16_MAX;
+
+// The simulation loop works on a process table instead of copying PCBs between queues. The state
+// that changes every tick is stored as narrow structure-of-arrays columns so a scan over a queue only
+// pulls in the bytes it compares, and every queue holds 32-bit indices into the table. Cold data
+// (sizes, arrival data, priority, fairness counters) stays in pcb; the hot fields of those PCBs are
+// stale during a run, use get_PCB() for a complete copy.
+struct process_table
+{
+    std::vector<uint32_t> remaining_time;
+    std::vector<uint32_t> time_since_io;
+    std::vector<uint16_t> time_slice_time; // only ever holds one quantum
+    std::vector<uint32_t> io_return_time;
+    std::vector<uint8_t> state;
+
+    std::vector<PCB> pcb;
+};
+
+// Builds the process table from the parsed input, index i is the i-th input line
+inline process_table build_process_table(const std::vector<PCB> &processes)
+{
+    process_table table;
+    std::size_t count = processes.size();
+
+    table.remaining_time.reserve(count);
+    table.time_since_io.reserve(count);
+    table.time_slice_time.reserve(count);
+    table.io_return_time.reserve(count);
+    table.state.reserve(count);
+    table.pcb = processes;
+
+    for (const auto &process : processes)
+    {
+        table.remaining_time.push_back(process.remaining_time);
+        table.time_since_io.push_back(process.time_since_io);
+        table.time_slice_time.push_back(process.time_slice_time);
+        table.io_return_time.push_back(process.io_return_time);
+        table.state.push_back(process.state);
+    }
+
+    return table;
+}
+
+// Returns a complete copy of a PCB, with the hot fields taken from the table
+inline PCB get_PCB(const process_table &table, uint32_t index)
+{
+    PCB process = table.pcb[index];
+    process.remaining_time = table.remaining_time[index];
+    process.time_since_io = table.time_since_io[index];
+    process.time_slice_time = table.time_slice_time[index];
+    process.io_return_time = table.io_return_time[index];
+    process.state = (states)table.state[index];
+    return process;
+}
+
+// Table indices sorted by arrival time, processes arriving together keep their input order
+inline std::vector<uint32_t> arrival_order(const process_table &table)
+{
+    std::vector<uint32_t> order(table.pcb.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&table](uint32_t a, uint32_t b)
+                     { return table.pcb[a].arrival_time < table.pcb[b].arrival_time; });
+    return order;
+}
+
+// Collects every process that has arrived by current_time into arrived, in input order. This
+// replaces the scan over the whole (shrinking) input list on every tick with a cursor.
+inline void collect_arrivals(const process_table &table, const std::vector<uint32_t> &order, std::size_t &next_arrival,
+                      unsigned int current_time, std::vector<uint32_t> &arrived)
+{
+    arrived.clear();
+    while (next_arrival < order.size() && table.pcb[order[next_arrival]].arrival_time <= current_time)
+    {
+        arrived.push_back(order[next_arrival]);
+        next_arrival += 1;
+    }
+    std::sort(arrived.begin(), arrived.end());
+}
+
+// Moves a process to a new state and charges the time spent in the old state to its counters
+inline void change_state(process_table &table, uint32_t index, states new_state, unsigned int current_time)
+{
+    PCB &process = table.pcb[index];
+    states old_state = (states)table.state[index];
+    unsigned int elapsed = current_time - process.state_entered;
+    process.time_in_state[old_state] += elapsed;
+
+    if (old_state == READY)
+    {
+        process.longest_ready_wait = std::max(process.longest_ready_wait, elapsed);
+    }
+    if (old_state == RUNNING && new_state == READY)
+    {
+        process.preemptions += 1;
+    }
+    if (new_state == WAITING)
+    {
+        process.io_waits += 1;
+    }
+    if (new_state == READY)
+    {
+        process.ready_since = current_time;
+    }
+
+    table.state[index] = new_state;
+    process.state_entered = current_time;
+}
+
+// Priority used by the EP schedulers. Aging is applied lazily from the time the process entered READY,
+// so nothing in the ready queue has to be touched while it waits; a process gains one level every
+// aging_interval ms (0 disables aging), up to level 0 (or its own level if it already starts above 0).
+inline int effective_priority(const process_table &table, uint32_t index, unsigned int current_time, unsigned int aging_interval)
+{
+    const PCB &process = table.pcb[index];
+    if (aging_interval == 0 || table.state[index] != READY || current_time < process.ready_since)
+    {
+        return process.priority;
+    }
+
+    int boost = (current_time - process.ready_since) / aging_interval;
+    return std::max(process.priority - boost, std::min(process.priority, 0));
+}
+
+// Complete PCBs of every process in the table, for the reports at the end of a run
+inline std::vector<PCB> table_snapshot(const process_table &table)
+{
+    std::vector<PCB> processes;
+    processes.reserve(table.pcb.size());
+    for (uint32_t i = 0; i < table.pcb.size(); i++)
+    {
+        processes.push_back(get_PCB(table, i));
+    }
+    return processes;
+}
+
+//------------------------------------------------SIMULATOR API------------------------------------------
+
+enum scheduling_policy
+{
+    ROUND_ROBIN,         // RR: FCFS ready queue with a time quantum
+    EXTERNAL_PRIORITY,   // EP: non-preemptive priority
+    EXTERNAL_PRIORITY_RR // EP_RR: preemptive priority with a time quantum (see preemption.md)
+};
+
+// Short name used in the output file names (executionRR.txt, ...)
+inline const char *policy_name(scheduling_policy policy)
+{
+    const char *names[] = {"RR", "EP", "EP_RR"};
+    return names[policy];
+}
+
+// Live view of a running Simulator for another thread (see telemetry.hpp). The simulator is the only
+// writer and publishes with relaxed stores every 64 steps, so readers see a picture a few microseconds
+// old without slowing the loop down.
+struct sim_telemetry
+{
+    explicit sim_telemetry(std::size_t partition_count) : partition_occupant(partition_count) {}
+
+    std::atomic<unsigned int> time{0};
+    std::atomic<unsigned long long> transitions{0};
+    std::atomic<uint32_t> ready{0};
+    std::atomic<uint32_t> waiting{0};
+    std::atomic<uint32_t> memory_waiting{0};
+    std::atomic<uint32_t> in_state[STATE_COUNT] = {}; // processes per states value
+    std::vector<std::atomic<int>> partition_occupant; // PID per partition, -1 when free
+    std::atomic<bool> finished{false};
+};
+
+class timeseries_writer;
+
+struct SimConfig
+{
+    scheduling_policy policy = EXTERNAL_PRIORITY;
+    unsigned int time_quantum = 100;    // ms, 1 to MAX_TIME_QUANTUM
+    unsigned int aging_interval = 0;    // ms in READY per priority level gained, 0 disables aging
+    unsigned int max_wait_alert = 1000; // waits longer than this are flagged in the fairness report
+    std::vector<memory_partition> partitions = default_partitions();
+
+    // Medium-term scheduling: when a process finds no free partition it fits in, the READY or WAITING
+    // holder of such a partition with the worst priority below its own is suspended to the backing store
+    // (SUSPENDED_READY / SUSPENDED_WAITING) to make room. The newcomer becomes READY once the victim has
+    // been written out; a suspended process gets a partition back when one frees up, before any NEW
+    // process, and becomes READY once it has been read back in.
+    bool swapping = false;
+    unsigned int swap_out_time = 10; // ms to write a victim out
+    unsigned int swap_in_time = 10;  // ms to read a suspended process back in
+
+    // Paged memory (paging.hpp): with frames > 0 the partitions are not used, processes are admitted
+    // straight away and fault their pages into a pool of frames of 1MB each
+    unsigned int frames = 0;
+    page_replacement replacement = REPLACE_LRU;
+    unsigned int tlb_entries = 16;
+    unsigned int working_set = 8;     // pages the references of one CPU burst stay within
+    unsigned int page_fault_time = 5; // ms in WAITING to read a page in
+
+    // Frequency scaling and energy accounting (energy.hpp), off unless dvfs.governor is set
+    dvfs_config dvfs;
+
+    // Continuous runs (load_generator.hpp): the table slot of a terminated process is handed to the
+    // next spawn(), so the table stays as large as the most processes ever alive at once
+    bool recycle_terminated = false;
+
+    bool record_execution = true; // build the execution table text in SimResult::execution
+
+    // Sinks of the kernel-steps, memory and debug levels (sim_log.hpp), not owned; the transitions
+    // level is record_execution and execution_output, the summary is up to the caller
+    sim_log *log = nullptr;
+
+    // When set, the execution table is streamed here in 64KB chunks instead of being returned in
+    // SimResult::execution, so long runs don't hold the whole table in memory
+    std::ostream *execution_output = nullptr;
+
+    // When set, kept up to date during the run; needs at least as many partitions as the config
+    sim_telemetry *telemetry = nullptr;
+
+    // When set, gets the load of every simulated ms (timeseries.hpp)
+    timeseries_writer *timeseries = nullptr;
+};
+
+struct SimResult
+{
+    std::string execution;      // the execution table, as written to execution<SCHED>.txt
+    std::string fairness;       // the fairness report, as written to fairness<SCHED>.csv
+    std::vector<PCB> processes; // final PCB of every process, in input order
+    unsigned int end_time;
+    unsigned long long transitions;
+    phase_profile profile; // empty unless built with SIM_PHASE_TIMERS
+    paging_stats paging;   // all zero unless SimConfig::frames > 0
+    std::vector<uint32_t> stuck; // processes left behind when the run stopped stuck(), by index
+    energy_stats energy;         // empty unless SimConfig::dvfs has a governor
+};
+
+// What the system is doing at one point in time, from counters kept up to date by the loop
+struct sim_load
+{
+    uint8_t cpu_busy;
+    uint32_t ready;
+    uint32_t waiting;        // WAITING, for I/O or a page
+    uint32_t memory_waiting; // NEW processes without memory
+    uint32_t suspended;      // SUSPENDED_READY and SUSPENDED_WAITING
+    uint32_t memory_used;    // MB of partitions held, or of frames in use with paged memory
+    uint32_t memory_units;   // partitions held, or frames in use
+};
+
+// One row of the execution table
+struct sim_transition
+{
+    unsigned int time;
+    uint32_t process; // index of the process in the input
+    int PID;
+    states old_state;
+    states new_state;
+    unsigned int since; // time the process entered old_state
+};
+
+// Callbacks for tools that consume the simulation in memory. They are called synchronously from the
+// simulation loop, so they should be cheap.
+class SimObserver
+{
+public:
+    virtual ~SimObserver() = default;
+
+    virtual void on_transition(const sim_transition &transition) {}
+
+    // A partition was given to a process or freed (partition.occupied is -1)
+    virtual void on_partition(unsigned int time, const memory_partition &partition) {}
+
+    virtual void on_finish(const SimResult &result) {}
+};
+
+class Simulator
+{
+public:
+    explicit Simulator(const SimConfig &config = SimConfig());
+
+    // Observers are not owned and must outlive the run
+    void add_observer(SimObserver *observer);
+
+    // Simulates the processes to completion; bursts holds the runs of their I/O profiles, if any
+    SimResult run(const std::vector<PCB> &processes, const std::vector<burst_run> &bursts = {});
+
+    // Step-wise use: load() a trace, step() until finished(), then finish() for the result. order is
+    // arrival_order() of the trace when the caller has it already (see check_trace()), empty otherwise.
+    void load(const std::vector<PCB> &processes, const std::vector<burst_run> &bursts = {},
+              std::vector<uint32_t> order = {});
+    bool finished() const;
+    void step();
+
+    // No progress is possible any more: processes are left, but none runs, is ready, waits for I/O or a
+    // swap, and none arrives later. Every partition is free by then, so the ones left (NEW, waiting for
+    // memory) fit in none of them. run_until() stops there instead of ticking for ever. Only the last
+    // process leaving the CPU or an arrival finding no memory can get a run stuck, so the test (O(1),
+    // from the queue sizes) is made on those events and not on every ms, most of which are idle.
+    bool stuck() const { return stalled; }
+
+    SimResult finish();
+
+    // Steps until the run finishes or is stuck, the clock reaches end_time or max_steps steps were taken, whichever
+    // comes first; returns the number of steps taken
+    unsigned long long run_until(unsigned int end_time, unsigned long long max_steps);
+
+    // Binary snapshot of the run so far (simulator_checkpoint.cpp); a Simulator restored from it
+    // continues exactly where this one stopped. Pending execution text is flushed to execution_output
+    // first, or stored in the snapshot when there is no execution_output.
+    bool save_checkpoint(std::ostream &output);
+    bool load_checkpoint(std::istream &input);
+
+    // What-if runs: run_shared_prefix() steps while the outcome does not depend on the policy or the
+    // aging interval and stops inside the first step that does (a dispatch with more than one process
+    // ready, a quantum expiry with someone waiting, or a better priority becoming ready); it returns
+    // false when the run finished (or got stuck) first. fork() then copies the run into a Simulator
+    // with another scheduling config (partitions excluded) that continues from there. Variants should
+    // keep the quantum of the prefix.
+    bool run_shared_prefix();
+    Simulator fork(const SimConfig &variant) const;
+
+    // Adds a process to a loaded run; it arrives at its arrival_time, which must not be before now().
+    // Returns its table index (a recycled one with SimConfig::recycle_terminated). Not for paged memory.
+    uint32_t spawn(const PCB &process);
+
+    // Bytes of the execution table written to execution_output so far
+    unsigned long long execution_written() const { return execution_offset; }
+
+    unsigned int now() const { return current_time; }
+    const process_table &processes() const { return table; } // hot PCB fields are in the columns, see get_PCB()
+    unsigned long long transition_count() const { return transitions; }
+    sim_load current_load() const;
+    const SimConfig &configuration() const { return config; }
+
+private:
+    // The phases of one iteration of the simulation loop
+    void admit_arrivals();
+    void manage_wait_queue();
+    void preempt();
+    void dispatch();
+    void execute();
+    void admit_memory_waiters();
+    void complete_swaps();
+    bool policy_sensitive() const;
+    bool scaled_work_done();
+    void wake_cpu();
+    void switch_p_state(uint32_t state);
+    bool no_progress_possible() const
+    {
+        return running == NO_PROCESS && ready_queue.empty() && wait_queue.empty() && swap_queue.empty() &&
+               next_arrival == arrivals.size() && !finished();
+    }
+
+    void transition(uint32_t process, states new_state);
+    bool allocate(uint32_t process);
+    void release(uint32_t process);
+    bool swap_out_for(uint32_t process);
+    void swap_in(uint32_t process);
+    void notify_partition(int partition_number);
+    void check_priority(uint32_t process);
+    void sort_by_priority();
+    void flush_execution();
+    void log_kernel_steps(const std::string &steps);
+    void log_debug(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    void reserve_run_state();
+    bool restored_state_valid() const;
+    void publish();
+    void publish_partitions();
+
+    SimConfig config;
+    std::vector<SimObserver *> observers;
+
+    // Every process lives in the table, the queues below only hold indices into it
+    process_table table;
+    std::vector<uint32_t> arrivals; // table indices in arrival order
+    std::vector<burst_run> bursts;  // I/O profile runs, indexed by the PCBs' burst ranges
+    std::size_t next_arrival;       // next entry of arrivals that has not arrived yet
+    uint32_t terminated;
+    std::vector<uint32_t> free_slots; // terminated processes to recycle (SimConfig::recycle_terminated)
+
+    std::vector<uint32_t> ready_queue;
+    std::vector<uint32_t> wait_queue;
+    std::vector<uint32_t> memory_wait_queue;
+    std::vector<uint32_t> arrived; // processes arriving on the current tick
+
+    // Swapping (SimConfig::swapping): transfers in flight finish at the process's io_return_time
+    std::vector<uint32_t> swap_queue;      // NEW processes waiting for a swap-out, or swap-ins
+    std::vector<uint32_t> suspended_queue; // SUSPENDED_READY processes without a partition, oldest first
+
+    std::vector<memory_partition> partitions;
+    std::vector<uint32_t> partition_holder; // table index of each partition's occupant, NO_PROCESS when free
+    uint32_t partition_memory_used;         // MB of the partitions held
+    uint32_t partitions_used;
+    paged_memory memory;                    // used instead of the partitions when SimConfig::frames > 0
+    dvfs_state dvfs;                        // P-state and energy counters when SimConfig::dvfs has a governor
+    uint32_t state_counts[STATE_COUNT];     // processes per states value
+    unsigned int unpublished_steps; // steps since the telemetry was last refreshed
+
+    unsigned int current_time;
+    uint32_t running;
+    bool stalled; // see stuck()
+    bool higher_priority_arrived; // set during admission, used by EP_RR's preemption
+    bool admitted;                // the admission phases of the current step already ran (fork point)
+
+    phase_profile profile;
+
+    std::string execution_status;      // execution table text not yet written to execution_output
+    unsigned long long execution_offset; // bytes already written to execution_output
+    unsigned long long transitions;
+};
+
+// main() of the interrupts_RR, interrupts_EP and interrupts_EP_RR programs (simulator_cli.cpp)
+int simulator_main(int argc, char **argv, scheduling_policy policy);
+
+// Applies one of the simulator_main() options that only set SimConfig fields (--quantum-ms, --frames,
+// --swap-out-ms, --dvfs, ...). Returns false when option is none of them; error says what is wrong
+// with value, and is empty when it was applied.
+bool parse_config_option(const std::string &option, const std::string &value, SimConfig &config, std::string &error);
+
+// The stuck() report of a run: when it stopped and the processes that can never get memory
+void print_stuck(const SimResult &result, unsigned int largest, std::ostream &output);
+
+// The summary lines that depend on the config: the paging counters and the energy report, when on
+std::string print_run_summary(const SimResult &result, const SimConfig &config);
+
+#endif
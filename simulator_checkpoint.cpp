@@ -0,0 +1,381 @@
+/**
+ * @file simulator_checkpoint.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Binary checkpoints of a running Simulator
+ *
+ * A snapshot is the run's whole state in native byte order: the config that shapes the schedule,
+ * the process table columns and PCBs, the I/O profiles, the arrival cursor, the queues (the swapping ones included),
+ * the partitions and their holders, the paged memory, the P-state and energy counters, the clock, how
+ * far the current step got (a run stopped at a fork point is mid-step) and the execution table text
+ * not yet written out. Every vector is a 64-bit length followed by its raw elements (all of them
+ * trivially copyable), and the file starts and ends with a magic string so a truncated or foreign
+ * file is rejected. What a file restores is checked before it is used: the enums must be in range,
+ * the table columns as long as the PCBs and every index (queues, partition holders, bursts, P-states,
+ * pages and frames) inside what it points into, so a damaged file fails to load instead of crashing
+ * the run later. Snapshots are meant to be resumed on the same build.
+ */
+
+#include <simulator.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+static const char CHECKPOINT_MAGIC[8] = {'S', 'I', 'M', 'C', 'K', 'P', 'T', '1'};
+
+template <typename T>
+static void write_value(std::ostream &output, const T &value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint fields must be trivially copyable");
+    output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+static void write_vector(std::ostream &output, const std::vector<T> &values)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "checkpoint fields must be trivially copyable");
+    write_value(output, (uint64_t)values.size());
+    output.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+static void write_string(std::ostream &output, const std::string &text)
+{
+    write_value(output, (uint64_t)text.size());
+    output.write(text.data(), text.size());
+}
+
+template <typename T>
+static bool read_value(std::istream &input, T &value)
+{
+    return (bool)input.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+// Reads in 1MB steps so a corrupt length fails on the stream instead of on one huge allocation
+template <typename T>
+static bool read_vector(std::istream &input, std::vector<T> &values)
+{
+    uint64_t count = 0;
+    if (!read_value(input, count))
+    {
+        return false;
+    }
+
+    const uint64_t chunk = (1 << 20) / sizeof(T) + 1;
+    values.clear();
+    for (uint64_t done = 0; done < count; done += chunk)
+    {
+        uint64_t step = std::min(chunk, count - done);
+        values.resize(done + step);
+        if (!input.read(reinterpret_cast<char *>(values.data() + done), step * sizeof(T)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool read_string(std::istream &input, std::string &text)
+{
+    std::vector<char> characters;
+    if (!read_vector(input, characters))
+    {
+        return false;
+    }
+    text.assign(characters.begin(), characters.end());
+    return true;
+}
+
+// Whether every entry is below limit; none (NO_PROCESS, NO_FRAME) passes too when allowed
+static bool all_below(const std::vector<uint32_t> &values, uint64_t limit, bool none_allowed = false)
+{
+    return std::all_of(values.begin(), values.end(), [&](uint32_t value)
+                       { return value < limit || (none_allowed && value == UINT32_MAX); });
+}
+
+static bool read_magic(std::istream &input)
+{
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC);
+}
+
+bool Simulator::save_checkpoint(std::ostream &output)
+{
+    // Whatever is already in execution_output belongs to the snapshot's past
+    if (config.execution_output != nullptr)
+    {
+        flush_execution();
+        config.execution_output->flush();
+    }
+
+    output.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+
+    write_value(output, config.policy);
+    write_value(output, config.time_quantum);
+    write_value(output, config.aging_interval);
+    write_value(output, config.max_wait_alert);
+    write_value(output, config.record_execution);
+    write_value(output, config.swapping);
+    write_value(output, config.swap_out_time);
+    write_value(output, config.swap_in_time);
+    write_value(output, config.frames);
+    write_value(output, config.replacement);
+    write_value(output, config.tlb_entries);
+    write_value(output, config.working_set);
+    write_value(output, config.page_fault_time);
+    write_value(output, config.recycle_terminated);
+    write_value(output, config.dvfs.governor);
+    write_vector(output, config.dvfs.p_states);
+    write_vector(output, config.dvfs.c_states);
+    write_value(output, config.dvfs.switch_latency);
+    write_value(output, config.dvfs.interval);
+    write_value(output, config.dvfs.up_depth);
+    write_value(output, config.dvfs.down_depth);
+    write_value(output, config.dvfs.power_budget);
+
+    write_vector(output, table.remaining_time);
+    write_vector(output, table.time_since_io);
+    write_vector(output, table.time_slice_time);
+    write_vector(output, table.io_return_time);
+    write_vector(output, table.state);
+    write_vector(output, table.pcb);
+
+    write_vector(output, arrivals);
+    write_vector(output, bursts);
+    write_value(output, (uint64_t)next_arrival);
+    write_value(output, terminated);
+    write_vector(output, free_slots);
+
+    write_vector(output, ready_queue);
+    write_vector(output, wait_queue);
+    write_vector(output, memory_wait_queue);
+    write_vector(output, swap_queue);
+    write_vector(output, suspended_queue);
+    write_vector(output, partitions);
+    write_vector(output, partition_holder);
+
+    write_vector(output, memory.first_page);
+    write_vector(output, memory.page_frame);
+    write_vector(output, memory.frame_page);
+    write_vector(output, memory.frame_prev);
+    write_vector(output, memory.frame_next);
+    write_vector(output, memory.frame_referenced);
+    write_vector(output, memory.free_frames);
+    write_value(output, memory.oldest);
+    write_value(output, memory.newest);
+    write_value(output, memory.clock_hand);
+    write_vector(output, memory.tlb);
+    write_value(output, memory.tlb_next);
+    write_vector(output, memory.fault_served);
+    write_value(output, memory.stats);
+
+    write_value(output, dvfs.p_state);
+    write_value(output, dvfs.work_credit);
+    write_value(output, dvfs.busy_until);
+    write_value(output, dvfs.next_decision);
+    write_vector(output, dvfs.stats.busy_ms);
+    write_vector(output, dvfs.stats.idle_ms);
+    write_vector(output, dvfs.stats.wakeups);
+    write_value(output, dvfs.stats.switches);
+
+    write_value(output, current_time);
+    write_value(output, running);
+    write_value(output, higher_priority_arrived);
+    write_value(output, admitted);
+    write_value(output, transitions);
+    write_value(output, execution_offset);
+    write_string(output, execution_status);
+
+    output.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    return (bool)output.flush();
+}
+
+bool Simulator::restored_state_valid() const
+{
+    const uint64_t processes = table.pcb.size();
+    // compared unsigned, so a value below the first enumerator fails too
+    if ((unsigned int)config.policy > EXTERNAL_PRIORITY_RR || (unsigned int)config.replacement > REPLACE_CLOCK ||
+        (unsigned int)config.dvfs.governor > GOVERNOR_ENERGY)
+    {
+        return false;
+    }
+
+    if (table.remaining_time.size() != processes || table.time_since_io.size() != processes ||
+        table.time_slice_time.size() != processes || table.io_return_time.size() != processes ||
+        table.state.size() != processes ||
+        !std::all_of(table.state.begin(), table.state.end(), [](uint8_t state)
+                     { return state < STATE_COUNT; }) ||
+        (std::ptrdiff_t)terminated != std::count(table.state.begin(), table.state.end(), (uint8_t)TERMINATED))
+    {
+        return false;
+    }
+    for (const PCB &process : table.pcb)
+    {
+        bool profile = process.burst_first != process.burst_end;
+        if (process.burst_first > process.burst_end || process.burst_end > bursts.size() ||
+            (profile && (process.burst_cursor < process.burst_first || process.burst_cursor >= process.burst_end)))
+        {
+            return false;
+        }
+    }
+
+    if (!all_below(arrivals, processes) || next_arrival > arrivals.size() || !all_below(free_slots, processes) ||
+        !all_below(ready_queue, processes) || !all_below(wait_queue, processes) ||
+        !all_below(memory_wait_queue, processes) || !all_below(swap_queue, processes) ||
+        !all_below(suspended_queue, processes) || (running != NO_PROCESS && running >= processes) ||
+        partition_holder.size() != partitions.size() || !all_below(partition_holder, processes, true))
+    {
+        return false;
+    }
+
+    const auto &p_states = config.dvfs.p_states;
+    const auto &c_states = config.dvfs.c_states;
+    std::string dvfs_error;
+    if ((config.dvfs.governor != GOVERNOR_OFF && !check_dvfs_config(config.dvfs, dvfs_error)) ||
+        dvfs.stats.busy_ms.size() != p_states.size() || dvfs.stats.idle_ms.size() != c_states.size() ||
+        dvfs.stats.wakeups.size() != c_states.size() ||
+        (p_states.empty() ? dvfs.p_state != 0 : dvfs.p_state >= p_states.size()))
+    {
+        return false;
+    }
+
+    if (config.frames == 0)
+    {
+        return memory.first_page.empty() && memory.page_frame.empty() && memory.frame_page.empty() &&
+               memory.frame_prev.empty() && memory.frame_next.empty() && memory.frame_referenced.empty() &&
+               memory.free_frames.empty() && memory.tlb.empty() && memory.fault_served.empty();
+    }
+    const uint64_t frames = config.frames;
+    // every process has at least one page, so the first pages strictly increase
+    if (memory.first_page.size() != processes + 1 || memory.first_page.front() != 0 ||
+        std::adjacent_find(memory.first_page.begin(), memory.first_page.end(), std::greater_equal<uint32_t>()) !=
+            memory.first_page.end() ||
+        memory.page_frame.size() != memory.first_page.back())
+    {
+        return false;
+    }
+    const uint64_t pages = memory.page_frame.size();
+    return memory.frame_page.size() == frames && memory.frame_prev.size() == frames &&
+           memory.frame_next.size() == frames && memory.frame_referenced.size() == frames &&
+           memory.free_frames.size() <= frames && memory.tlb.size() == config.tlb_entries &&
+           memory.fault_served.size() == processes &&
+           all_below(memory.page_frame, frames, true) && all_below(memory.frame_page, pages, true) &&
+           all_below(memory.frame_prev, frames, true) && all_below(memory.frame_next, frames, true) &&
+           all_below(memory.free_frames, frames) && all_below(memory.tlb, pages, true) &&
+           all_below({memory.oldest, memory.newest}, frames, true) && memory.clock_hand < frames &&
+           (memory.tlb.empty() ? memory.tlb_next == 0 : memory.tlb_next < memory.tlb.size());
+}
+
+// The snapshot replaces the scheduling part of the config; the output settings (log,
+// execution_output) and the observers stay as they are
+bool Simulator::load_checkpoint(std::istream &input)
+{
+    SimConfig previous = config;
+    uint64_t arrival_cursor = 0;
+    bool valid = read_magic(input) &&
+                 read_value(input, config.policy) &&
+                 read_value(input, config.time_quantum) &&
+                 config.time_quantum >= 1 && config.time_quantum <= MAX_TIME_QUANTUM &&
+                 read_value(input, config.aging_interval) &&
+                 read_value(input, config.max_wait_alert) &&
+                 read_value(input, config.record_execution) &&
+                 read_value(input, config.swapping) &&
+                 read_value(input, config.swap_out_time) &&
+                 read_value(input, config.swap_in_time) &&
+                 read_value(input, config.frames) &&
+                 read_value(input, config.replacement) &&
+                 read_value(input, config.tlb_entries) &&
+                 read_value(input, config.working_set) &&
+                 read_value(input, config.page_fault_time) &&
+                 read_value(input, config.recycle_terminated) &&
+                 read_value(input, config.dvfs.governor) &&
+                 read_vector(input, config.dvfs.p_states) &&
+                 read_vector(input, config.dvfs.c_states) &&
+                 read_value(input, config.dvfs.switch_latency) &&
+                 read_value(input, config.dvfs.interval) &&
+                 read_value(input, config.dvfs.up_depth) &&
+                 read_value(input, config.dvfs.down_depth) &&
+                 read_value(input, config.dvfs.power_budget) &&
+                 read_vector(input, table.remaining_time) &&
+                 read_vector(input, table.time_since_io) &&
+                 read_vector(input, table.time_slice_time) &&
+                 read_vector(input, table.io_return_time) &&
+                 read_vector(input, table.state) &&
+                 read_vector(input, table.pcb) &&
+                 read_vector(input, arrivals) &&
+                 read_vector(input, bursts) &&
+                 read_value(input, arrival_cursor) &&
+                 read_value(input, terminated) &&
+                 read_vector(input, free_slots) &&
+                 read_vector(input, ready_queue) &&
+                 read_vector(input, wait_queue) &&
+                 read_vector(input, memory_wait_queue) &&
+                 read_vector(input, swap_queue) &&
+                 read_vector(input, suspended_queue) &&
+                 read_vector(input, partitions) &&
+                 read_vector(input, partition_holder) &&
+                 read_vector(input, memory.first_page) &&
+                 read_vector(input, memory.page_frame) &&
+                 read_vector(input, memory.frame_page) &&
+                 read_vector(input, memory.frame_prev) &&
+                 read_vector(input, memory.frame_next) &&
+                 read_vector(input, memory.frame_referenced) &&
+                 read_vector(input, memory.free_frames) &&
+                 read_value(input, memory.oldest) &&
+                 read_value(input, memory.newest) &&
+                 read_value(input, memory.clock_hand) &&
+                 read_vector(input, memory.tlb) &&
+                 read_value(input, memory.tlb_next) &&
+                 read_vector(input, memory.fault_served) &&
+                 read_value(input, memory.stats) &&
+                 read_value(input, dvfs.p_state) &&
+                 read_value(input, dvfs.work_credit) &&
+                 read_value(input, dvfs.busy_until) &&
+                 read_value(input, dvfs.next_decision) &&
+                 read_vector(input, dvfs.stats.busy_ms) &&
+                 read_vector(input, dvfs.stats.idle_ms) &&
+                 read_vector(input, dvfs.stats.wakeups) &&
+                 read_value(input, dvfs.stats.switches) &&
+                 read_value(input, current_time) &&
+                 read_value(input, running) &&
+                 read_value(input, higher_priority_arrived) &&
+                 read_value(input, admitted) &&
+                 read_value(input, transitions) &&
+                 read_value(input, execution_offset) &&
+                 read_string(input, execution_status) &&
+                 read_magic(input) &&
+                 restored_state_valid();
+
+    if (!valid)
+    {
+        config = previous;
+        load({}); // don't leave a half-restored run behind
+        return false;
+    }
+
+    config.partitions = partitions;
+    next_arrival = arrival_cursor;
+    arrived.clear();
+    reserve_run_state();
+
+    std::fill(std::begin(state_counts), std::end(state_counts), 0);
+    for (uint8_t state : table.state)
+    {
+        state_counts[state] += 1;
+    }
+    partition_memory_used = 0;
+    partitions_used = 0;
+    for (const auto &partition : partitions)
+    {
+        if (partition.occupied != -1)
+        {
+            partition_memory_used += partition.size;
+            partitions_used += 1;
+        }
+    }
+    publish_partitions();
+    publish();
+
+    // idle steps don't look again, so a checkpoint of a stuck run has to stop right away
+    stalled = no_progress_possible();
+    return true;
+}
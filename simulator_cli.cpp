@@ -0,0 +1,748 @@
+/**
+ * @file simulator_cli.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Command line front end shared by the three scheduler programs
+ *
+ * Usage: ./interrupts_<SCHED> <input_file.txt | -> [aging_interval_ms] [options]
+ *        ./interrupts_<SCHED> --resume <checkpoint> [options]
+ *
+ * Options:
+ *   --checkpoint FILE        save a checkpoint of the run to FILE periodically
+ *   --checkpoint-sim-ms N    ... every N ms of simulated time
+ *   --checkpoint-wall-s N    ... every N seconds of wall time
+ *   --resume FILE            continue the run saved in FILE, appending to its execution<SCHED>.txt
+ *   --telemetry FILE         append a stats line to FILE ("-" for stderr) while the run goes on
+ *   --telemetry-interval-ms N  ... every N ms of wall time (default 1000)
+ *   --chrome-trace FILE      stream the timeline to FILE as Chrome Trace Event JSON
+ *   --snapshot FILE          dump the whole process table to FILE ("-" for stdout)
+ *   --snapshot-format F      ... as table (the default), csv or binary
+ *   --snapshot-at LIST       ... at the comma-separated simulated times (ms), or "transitions" for
+ *                            after every transition
+ *   --snapshot-every-ms N    ... every N ms of simulated time
+ *   --swap-out-ms N          suspend processes to a backing store to admit better ones (see
+ *                            SimConfig::swapping), writing a victim out takes N ms
+ *   --swap-in-ms N           ... and reading one back in N ms (both default to 10)
+ *   --quantum-ms N           time quantum of RR and EP_RR, 1 to 65535 (default 100)
+ *   --frames N               paged memory with a pool of N 1MB frames instead of the partitions
+ *   --replacement R          ... replacing pages with fifo, lru (the default) or clock
+ *   --tlb N                  ... through a TLB of N entries (default 16)
+ *   --working-set N          ... with CPU bursts referencing N pages each (default 8)
+ *   --page-fault-ms N        ... and N ms to serve a page fault (default 5)
+ *   --timeseries FILE        write the load (CPU, queue lengths, memory) over time to FILE ("-" for
+ *                            stdout), see timeseries.hpp
+ *   --timeseries-format F    ... as csv (the default) or columnar
+ *   --timeseries-every-ms N  ... every N ms of simulated time instead of on every change
+ *   --log-level L            output the levels up to L: off, summary, transitions, kernel-steps, memory
+ *                            or debug (see sim_log.hpp); the default is summary, transitions and memory
+ *   --log-to L=SINK          send level L to SINK, a file, "-" for stdout, "stderr" or "none" (by
+ *                            default the transitions go to execution<SCHED>.txt, debug to stderr and
+ *                            the rest to stdout)
+ *   --dvfs GOVERNOR          scale the CPU frequency with the performance, powersave, queue or energy
+ *                            governor and report the energy of the run (see energy.hpp)
+ *   --p-states LIST          ... with the P-states SPEED:WATTS,... fastest (1000) first
+ *   --c-states LIST          ... and the C-states WATTS:AFTER_MS:EXIT_US,... shallowest first
+ *   --p-switch-us N          ... a P-state change stalling the CPU for N µs (default 50)
+ *   --governor-ms N          ... the governor deciding every N ms of busy CPU (default 10)
+ *   --governor-up N          ... going to the fastest P-state with N processes ready (default 2)
+ *   --governor-down N        ... queue slowing down with N or fewer ready (default 0)
+ *   --power-budget W         ... never using a P-state drawing more than W watts
+ *   --check MODE             what to do with a trace the simulator can't run (duplicate PIDs, processes
+ *                            larger than every partition or without CPU time, malformed lines): reject
+ *                            it (the default), clamp the values or only report them (see trace_check.hpp)
+ *   --replay-to SINK         replay the run against the wall clock, streaming its transitions to SINK: a
+ *                            file or FIFO, "-" for stdout, unix:PATH or tcp:HOST:PORT (see replay.hpp)
+ *   --replay-speed X         ... X simulated ms per wall ms (default 1)
+ *   --replay-batch-ms N      ... sleeping and writing every N ms of wall time (default 10)
+ */
+
+#include <chrome_trace.hpp>
+#include <replay.hpp>
+#include <simulator.hpp>
+#include <snapshot.hpp>
+#include <telemetry.hpp>
+#include <trace_check.hpp>
+#include <timeseries.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+
+struct checkpoint_schedule
+{
+    std::string path;
+    unsigned int sim_interval = 0;  // ms of simulated time, 0 = off
+    unsigned int wall_interval = 0; // seconds of wall time, 0 = off
+};
+
+struct snapshot_schedule
+{
+    std::string path;
+    snapshot_format format = SNAPSHOT_TABLE;
+    std::vector<unsigned int> times; // sorted
+    unsigned int interval = 0;       // ms of simulated time, 0 = off
+    bool transitions = false;
+};
+
+// "transitions" or a comma-separated list of times
+static bool parse_snapshot_times(const std::string &value, snapshot_schedule &schedule)
+{
+    if (value == "transitions")
+    {
+        schedule.transitions = true;
+        return true;
+    }
+    std::stringstream list(value);
+    std::string time;
+    while (std::getline(list, time, ','))
+    {
+        if (time.empty() || time.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        schedule.times.push_back(std::stoul(time));
+    }
+    std::sort(schedule.times.begin(), schedule.times.end());
+    return true;
+}
+
+// First snapshot time at or after time, UINT_MAX when there is none
+static unsigned int next_snapshot(const snapshot_schedule &schedule, unsigned int time)
+{
+    unsigned int next = UINT_MAX;
+    auto listed = std::lower_bound(schedule.times.begin(), schedule.times.end(), time);
+    if (listed != schedule.times.end())
+    {
+        next = *listed;
+    }
+    if (schedule.interval > 0)
+    {
+        unsigned long long periodic = (time + (unsigned long long)schedule.interval - 1) / schedule.interval * schedule.interval;
+        next = std::min<unsigned long long>(next, periodic);
+    }
+    return next;
+}
+
+// Opens the sink of a log level: "-" is stdout, "stderr" stderr, "none" leaves the level off and anything
+// else is a file, opened once however many levels share it. Returns false when the file can't be opened.
+static bool open_log_sink(const std::string &path, std::map<std::string, std::unique_ptr<std::ofstream>> &files, std::ostream *&sink)
+{
+    if (path == "none")
+        sink = nullptr;
+    else if (path == "-")
+        sink = &std::cout;
+    else if (path == "stderr")
+        sink = &std::cerr;
+    else
+    {
+        std::unique_ptr<std::ofstream> &file = files[path];
+        if (file == nullptr)
+        {
+            file = std::make_unique<std::ofstream>(path, std::ios::trunc);
+        }
+        sink = file.get();
+        return file->is_open();
+    }
+    return true;
+}
+
+// Writes the checkpoint next to its final name and renames it over, so a kill while saving leaves the
+// previous checkpoint intact
+static bool write_checkpoint(Simulator &simulator, const std::string &path)
+{
+    std::string temporary = path + ".tmp";
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+    if (!output.is_open() || !simulator.save_checkpoint(output))
+    {
+        return false;
+    }
+    output.close();
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// Steps the simulation to the end, saving checkpoints and writing process table snapshots (when
+// snapshots is set) on their schedules, and paced against the wall clock when pacer is set
+static bool run_with_checkpoints(Simulator &simulator, const checkpoint_schedule &schedule,
+                                 const snapshot_schedule &snapshot_times, snapshot_writer *snapshots,
+                                 replay_pacer *pacer)
+{
+    using clock = std::chrono::steady_clock;
+    clock::time_point next_wall_checkpoint = clock::now() + std::chrono::seconds(schedule.wall_interval);
+    unsigned int end_time = (schedule.sim_interval > 0) ? simulator.now() + schedule.sim_interval : UINT_MAX;
+    unsigned int snapshot_time = (snapshots != nullptr) ? next_snapshot(snapshot_times, simulator.now()) : UINT_MAX;
+    if (pacer != nullptr)
+    {
+        pacer->start(simulator.now());
+    }
+
+    while (!simulator.finished() && !simulator.stuck())
+    {
+        if (simulator.now() == snapshot_time)
+        {
+            snapshots->write(simulator);
+            snapshot_time = (snapshot_time < UINT_MAX) ? next_snapshot(snapshot_times, snapshot_time + 1) : UINT_MAX;
+        }
+
+        // reading the clock every step would cost more than the step itself
+        unsigned long long max_steps = (schedule.wall_interval > 0) ? 1024 : ULLONG_MAX;
+        unsigned int stop_time = std::min(end_time, snapshot_time);
+        simulator.run_until((pacer != nullptr) ? std::min(stop_time, pacer->batch_end()) : stop_time, max_steps);
+        if (pacer != nullptr && simulator.now() >= pacer->batch_end() && !pacer->pace(simulator.now()))
+        {
+            std::cerr << "Error: the replay destination closed" << std::endl;
+            return false;
+        }
+
+        bool due = (schedule.sim_interval > 0 && simulator.now() >= end_time) ||
+                   (schedule.wall_interval > 0 && clock::now() >= next_wall_checkpoint);
+        if (due && !simulator.finished() && !simulator.stuck())
+        {
+            if (!write_checkpoint(simulator, schedule.path))
+            {
+                std::cerr << "Error: Unable to write checkpoint " << schedule.path << std::endl;
+                return false;
+            }
+            next_wall_checkpoint = clock::now() + std::chrono::seconds(schedule.wall_interval);
+        }
+        if (schedule.sim_interval > 0 && simulator.now() >= end_time)
+        {
+            end_time = simulator.now() + schedule.sim_interval;
+        }
+    }
+
+    // a snapshot due at the very end shows the finished table
+    if (simulator.now() == snapshot_time)
+    {
+        snapshots->write(simulator);
+    }
+    if (pacer != nullptr && !pacer->pace(simulator.now()))
+    {
+        std::cerr << "Error: the replay destination closed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Mean turnaround of the processes that terminated
+static double mean_turnaround(const SimResult &result)
+{
+    double total = 0;
+    std::size_t count = 0;
+    for (const auto &process : result.processes)
+    {
+        if (process.state == TERMINATED)
+        {
+            total += process.state_entered - process.arrival_time;
+            count += 1;
+        }
+    }
+    return (count > 0) ? total / count : 0;
+}
+
+bool parse_config_option(const std::string &option, const std::string &value, SimConfig &config, std::string &error)
+{
+    error.clear();
+    if (option == "--quantum-ms")
+    {
+        unsigned long quantum = std::stoul(value);
+        if (quantum < 1 || quantum > MAX_TIME_QUANTUM)
+            error = "--quantum-ms takes 1 to " + std::to_string(MAX_TIME_QUANTUM) + " ms";
+        else
+            config.time_quantum = quantum;
+    }
+    else if (option == "--frames")
+        config.frames = std::stoul(value);
+    else if (option == "--replacement")
+    {
+        if (value == "fifo")
+            config.replacement = REPLACE_FIFO;
+        else if (value == "lru")
+            config.replacement = REPLACE_LRU;
+        else if (value == "clock")
+            config.replacement = REPLACE_CLOCK;
+        else
+            error = "--replacement takes fifo, lru or clock";
+    }
+    else if (option == "--tlb")
+        config.tlb_entries = std::stoul(value);
+    else if (option == "--working-set")
+        config.working_set = std::stoul(value);
+    else if (option == "--page-fault-ms")
+        config.page_fault_time = std::stoul(value);
+    else if (option == "--swap-out-ms")
+    {
+        config.swapping = true;
+        config.swap_out_time = std::stoul(value);
+    }
+    else if (option == "--swap-in-ms")
+    {
+        config.swapping = true;
+        config.swap_in_time = std::stoul(value);
+    }
+    else if (option == "--dvfs")
+    {
+        if (!parse_governor(value, config.dvfs.governor))
+            error = "--dvfs takes performance, powersave, queue or energy";
+    }
+    else if (option == "--p-states")
+    {
+        if (!parse_p_states(value, config.dvfs.p_states))
+            error = "--p-states takes SPEED:WATTS,..., e.g. 1000:12,600:4";
+    }
+    else if (option == "--c-states")
+    {
+        if (!parse_c_states(value, config.dvfs.c_states))
+            error = "--c-states takes WATTS:AFTER_MS:EXIT_US,..., e.g. 2:0:0,0.1:50:400";
+    }
+    else if (option == "--p-switch-us")
+        config.dvfs.switch_latency = std::stoul(value);
+    else if (option == "--governor-ms")
+        config.dvfs.interval = std::stoul(value);
+    else if (option == "--governor-up")
+        config.dvfs.up_depth = std::stoul(value);
+    else if (option == "--governor-down")
+        config.dvfs.down_depth = std::stoul(value);
+    else if (option == "--power-budget")
+        config.dvfs.power_budget = std::stod(value);
+    else
+        return false;
+    return true;
+}
+
+void print_stuck(const SimResult &result, unsigned int largest, std::ostream &output)
+{
+    output << "Error: no progress possible at " << result.end_time << "ms, " << result.stuck.size()
+           << ((result.stuck.size() == 1) ? " process" : " processes") << " can never get memory (the largest partition is "
+           << largest << "MB):" << std::endl;
+    std::size_t shown = std::min<std::size_t>(result.stuck.size(), 20);
+    for (std::size_t i = 0; i < shown; i++)
+    {
+        const PCB &process = result.processes[result.stuck[i]];
+        output << "  PID " << process.PID << ", " << process.size << "MB, " << process.state << " since "
+               << process.state_entered << "ms" << std::endl;
+    }
+    if (shown < result.stuck.size())
+    {
+        output << "  ... and " << result.stuck.size() - shown << " more" << std::endl;
+    }
+}
+
+std::string print_run_summary(const SimResult &result, const SimConfig &config)
+{
+    std::string summary;
+    if (config.frames > 0)
+    {
+        const paging_stats &paging = result.paging;
+        summary += "Paging (" + std::to_string(config.frames) + " frames, " + replacement_name(config.replacement) +
+                   "): " + std::to_string(paging.references) + " references, " + std::to_string(paging.tlb_hits) +
+                   " TLB hits, " + std::to_string(paging.page_faults) + " page faults, " +
+                   std::to_string(paging.evictions) + " evictions\n";
+    }
+    if (config.dvfs.governor != GOVERNOR_OFF)
+    {
+        summary += print_energy(result.energy, config.dvfs, result.end_time, result.processes.size(), mean_turnaround(result));
+    }
+    return summary;
+}
+
+int simulator_main(int argc, char **argv, scheduling_policy policy)
+{
+    SimConfig config;
+    config.policy = policy;
+
+    std::vector<std::string> arguments;
+    checkpoint_schedule schedule;
+    std::string resume_path;
+    std::string telemetry_path;
+    unsigned int telemetry_interval = 1000;
+    std::string chrome_trace_path;
+    snapshot_schedule snapshot_times;
+    std::string timeseries_path;
+    timeseries_format series_format = TIMESERIES_CSV;
+    unsigned int series_interval = 0;
+    log_level selected_level = LOG_LEVEL_COUNT; // none selected
+    std::string log_paths[LOG_LEVEL_COUNT] = {"none", "-", "", "-", "-", "stderr"};
+    trace_check_mode check_mode = CHECK_REJECT;
+    std::string replay_path;
+    double replay_speed = 1;
+    unsigned int replay_batch = 10;
+    std::string error;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option.rfind("--", 0) != 0)
+        {
+            arguments.push_back(option);
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Error: missing value for " << option << std::endl;
+            return -1;
+        }
+        std::string value = argv[++i];
+
+        if (option == "--checkpoint")
+            schedule.path = value;
+        else if (option == "--checkpoint-sim-ms")
+            schedule.sim_interval = std::stoul(value);
+        else if (option == "--checkpoint-wall-s")
+            schedule.wall_interval = std::stoul(value);
+        else if (option == "--resume")
+            resume_path = value;
+        else if (option == "--telemetry")
+            telemetry_path = value;
+        else if (option == "--telemetry-interval-ms")
+            telemetry_interval = std::stoul(value);
+        else if (option == "--chrome-trace")
+            chrome_trace_path = value;
+        else if (option == "--snapshot")
+            snapshot_times.path = value;
+        else if (option == "--snapshot-format")
+        {
+            if (!parse_snapshot_format(value, snapshot_times.format))
+            {
+                std::cerr << "Error: --snapshot-format takes table, csv or binary" << std::endl;
+                return -1;
+            }
+        }
+        else if (option == "--snapshot-at")
+        {
+            if (!parse_snapshot_times(value, snapshot_times))
+            {
+                std::cerr << "Error: --snapshot-at takes a comma-separated list of times or \"transitions\"" << std::endl;
+                return -1;
+            }
+        }
+        else if (option == "--snapshot-every-ms")
+            snapshot_times.interval = std::stoul(value);
+        else if (option == "--timeseries")
+            timeseries_path = value;
+        else if (option == "--timeseries-format")
+        {
+            if (!parse_timeseries_format(value, series_format))
+            {
+                std::cerr << "Error: --timeseries-format takes csv or columnar" << std::endl;
+                return -1;
+            }
+        }
+        else if (option == "--timeseries-every-ms")
+            series_interval = std::stoul(value);
+        else if (option == "--log-level")
+        {
+            selected_level = parse_log_level(value);
+            if (selected_level == LOG_LEVEL_COUNT)
+            {
+                std::cerr << "Error: --log-level takes off, summary, transitions, kernel-steps, memory or debug" << std::endl;
+                return -1;
+            }
+        }
+        else if (option == "--log-to")
+        {
+            std::size_t equals = value.find('=');
+            log_level level = (equals == std::string::npos) ? LOG_LEVEL_COUNT : parse_log_level(value.substr(0, equals));
+            if (level == LOG_LEVEL_COUNT || level == LOG_OFF || equals + 1 == value.size())
+            {
+                std::cerr << "Error: --log-to takes LEVEL=SINK, e.g. kernel-steps=kernel.txt" << std::endl;
+                return -1;
+            }
+            log_paths[level] = value.substr(equals + 1);
+        }
+        else if (option == "--check")
+        {
+            if (!parse_trace_check_mode(value, check_mode))
+            {
+                std::cerr << "Error: --check takes reject, clamp or report" << std::endl;
+                return -1;
+            }
+        }
+        else if (option == "--replay-to")
+            replay_path = value;
+        else if (option == "--replay-speed")
+        {
+            replay_speed = std::stod(value);
+            if (!(replay_speed > 0))
+            {
+                std::cerr << "Error: --replay-speed takes a positive factor" << std::endl;
+                return -1;
+            }
+        }
+        else if (option == "--replay-batch-ms")
+            replay_batch = std::stoul(value);
+        else if (parse_config_option(option, value, config, error))
+        {
+            if (!error.empty())
+            {
+                std::cerr << "Error: " << error << std::endl;
+                return -1;
+            }
+        }
+        else
+        {
+            std::cerr << "Error: unknown option " << option << std::endl;
+            return -1;
+        }
+    }
+
+    // Get the input file from the user, EP and EP_RR also take an aging interval
+    std::size_t max_arguments = (policy == ROUND_ROBIN) ? 1 : 2;
+    if (resume_path.empty() && (arguments.empty() || arguments.size() > max_arguments))
+    {
+        if (policy == ROUND_ROBIN)
+        {
+            std::cout << "ERROR!\nExpected 1 argument, received " << arguments.size() << std::endl;
+            std::cout << "To run the program, do: ./interrutps <your_input_file.txt | ->" << std::endl;
+        }
+        else
+        {
+            std::cout << "ERROR!\nExpected 1 or 2 arguments, received " << arguments.size() << std::endl;
+            std::cout << "To run the program, do: ./interrutps <your_input_file.txt | -> [aging_interval_ms]" << std::endl;
+        }
+        return -1;
+    }
+
+    if ((schedule.sim_interval > 0 || schedule.wall_interval > 0) && schedule.path.empty())
+    {
+        std::cerr << "Error: --checkpoint-sim-ms and --checkpoint-wall-s need --checkpoint FILE" << std::endl;
+        return -1;
+    }
+
+    std::string dvfs_error;
+    if (config.dvfs.governor != GOVERNOR_OFF && !check_dvfs_config(config.dvfs, dvfs_error))
+    {
+        std::cerr << "Error: " << dvfs_error << std::endl;
+        return -1;
+    }
+
+    // Optional aging interval, 0 (the default) keeps priorities fixed
+    if (arguments.size() == 2)
+    {
+        config.aging_interval = std::stoi(arguments[1]);
+    }
+
+    // Without --log-level the output is the usual one: the summary, the execution table and the memory
+    std::string name = policy_name(policy);
+    bool logged[LOG_LEVEL_COUNT];
+    for (int level = LOG_OFF; level < LOG_LEVEL_COUNT; level++)
+    {
+        bool selected = (selected_level == LOG_LEVEL_COUNT)
+                            ? (level == LOG_SUMMARY || level == LOG_TRANSITIONS || level == LOG_MEMORY)
+                            : (level != LOG_OFF && level <= selected_level);
+        logged[level] = selected && level <= SIM_LOG_MAX_LEVEL && log_paths[level] != "none";
+    }
+
+    sim_log log;
+    std::map<std::string, std::unique_ptr<std::ofstream>> log_files;
+    for (int level = LOG_SUMMARY; level < LOG_LEVEL_COUNT; level++)
+    {
+        if (level != LOG_TRANSITIONS && logged[level] && !open_log_sink(log_paths[level], log_files, log.sinks[level]))
+        {
+            std::cerr << "Error: Unable to open file: " << log_paths[level] << std::endl;
+            return -1;
+        }
+    }
+    config.log = &log;
+    std::ostream *summary = log.sinks[LOG_SUMMARY];
+
+    // The execution table is streamed to its file so a checkpoint only has to remember its length
+    std::string execution_name = log_paths[LOG_TRANSITIONS].empty() ? "execution" + name + ".txt" : log_paths[LOG_TRANSITIONS];
+    bool execution_to_file = logged[LOG_TRANSITIONS] && execution_name != "-" && execution_name != "stderr";
+    std::ofstream execution_file;
+    config.record_execution = logged[LOG_TRANSITIONS];
+    config.execution_output = nullptr;
+    if (logged[LOG_TRANSITIONS])
+    {
+        config.execution_output = execution_to_file ? &execution_file : (execution_name == "-") ? &std::cout : &std::cerr;
+    }
+    if (logged[LOG_TRANSITIONS] && !execution_to_file && (!schedule.path.empty() || !resume_path.empty()))
+    {
+        std::cerr << "Error: checkpoints need the transitions in a file" << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<telemetry_reporter> reporter;
+    if (!telemetry_path.empty())
+    {
+        reporter = std::make_unique<telemetry_reporter>(telemetry_path, telemetry_interval, config.partitions);
+        if (!reporter->is_open())
+        {
+            std::cerr << "Error: Unable to open file: " << telemetry_path << std::endl;
+            return -1;
+        }
+        config.telemetry = reporter->telemetry();
+    }
+
+    std::unique_ptr<timeseries_writer> series;
+    if (!timeseries_path.empty())
+    {
+        series = std::make_unique<timeseries_writer>(timeseries_path, series_format, series_interval);
+        if (!series->is_open())
+        {
+            std::cerr << "Error: Unable to open file: " << timeseries_path << std::endl;
+            return -1;
+        }
+        config.timeseries = series.get();
+    }
+
+    Simulator simulator(config);
+
+    std::unique_ptr<chrome_trace_writer> chrome_trace;
+    if (!chrome_trace_path.empty())
+    {
+        chrome_trace = std::make_unique<chrome_trace_writer>(chrome_trace_path);
+        if (!chrome_trace->is_open())
+        {
+            std::cerr << "Error: Unable to open file: " << chrome_trace_path << std::endl;
+            return -1;
+        }
+        simulator.add_observer(chrome_trace.get());
+    }
+
+    std::unique_ptr<replay_pacer> pacer;
+    if (!replay_path.empty())
+    {
+        pacer = std::make_unique<replay_pacer>(replay_path, replay_speed, replay_batch);
+        if (!pacer->is_open())
+        {
+            std::cerr << "Error: Unable to open replay destination: " << replay_path << std::endl;
+            return -1;
+        }
+        simulator.add_observer(pacer.get());
+    }
+
+    std::unique_ptr<snapshot_writer> snapshots;
+    if (!snapshot_times.path.empty())
+    {
+        snapshots = std::make_unique<snapshot_writer>(snapshot_times.path, snapshot_times.format);
+        if (!snapshots->is_open())
+        {
+            std::cerr << "Error: Unable to open file: " << snapshot_times.path << std::endl;
+            return -1;
+        }
+        if (snapshot_times.transitions)
+        {
+            snapshots->snapshot_transitions(&simulator);
+            simulator.add_observer(snapshots.get());
+        }
+    }
+
+    if (!resume_path.empty())
+    {
+        std::ifstream checkpoint(resume_path, std::ios::binary);
+        if (!checkpoint.is_open() || !simulator.load_checkpoint(checkpoint))
+        {
+            std::cerr << "Error: Unable to read checkpoint: " << resume_path << std::endl;
+            return -1;
+        }
+        if (simulator.configuration().policy != policy)
+        {
+            std::cerr << "Error: " << resume_path << " is a checkpoint of the "
+                      << policy_name(simulator.configuration().policy) << " scheduler" << std::endl;
+            return -1;
+        }
+
+        // Drop whatever the interrupted run wrote after the checkpoint
+        std::error_code error;
+        if (execution_to_file && (std::filesystem::file_size(execution_name, error) < simulator.execution_written() || error))
+        {
+            std::cerr << "Error: " << execution_name << " is shorter than the checkpoint expects" << std::endl;
+            return -1;
+        }
+        if (execution_to_file)
+        {
+            std::filesystem::resize_file(execution_name, simulator.execution_written());
+            execution_file.open(execution_name, std::ios::binary | std::ios::app);
+        }
+    }
+    else
+    {
+        // Open the input file, "-" reads the trace from stdin (e.g. piped from trace_generator)
+        auto file_name = arguments[0];
+        std::ifstream input_file;
+        std::istream *input = &std::cin;
+        if (file_name != "-")
+        {
+            input_file.open(file_name);
+
+            // Ensure that the file actually opens
+            if (!input_file.is_open())
+            {
+                std::cerr << "Error: Unable to open file: " << file_name << std::endl;
+                return -1;
+            }
+            input = &input_file;
+        }
+
+        // Parse the entire input file and check it against the memory layout in one pass
+        trace_check_config check;
+        check.mode = check_mode;
+        check.largest_partition = largest_partition(config);
+        checked_trace trace = check_trace(*input, check);
+        if (!trace.issues.empty())
+        {
+            std::cerr << (trace.accepted ? "Warning: " : "Error: ") << file_name
+                      << ((check_mode == CHECK_CLAMP) ? " was clamped:" : ":") << std::endl;
+            print_trace_issues(trace, std::cerr);
+        }
+        if (!trace.accepted)
+        {
+            return -1;
+        }
+        simulator.load(trace.processes, trace.bursts, std::move(trace.arrival_order));
+        if (execution_to_file)
+        {
+            execution_file.open(execution_name, std::ios::binary | std::ios::trunc);
+        }
+    }
+
+    if (execution_to_file && !execution_file.is_open())
+    {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+
+    // With the list of processes, run the simulation
+    if (!run_with_checkpoints(simulator, schedule, snapshot_times, snapshots.get(), pacer.get()))
+    {
+        return -1;
+    }
+    SimResult result = simulator.finish();
+    if (!result.stuck.empty())
+    {
+        print_stuck(result, largest_partition(simulator.configuration()), std::cerr);
+    }
+
+    execution_file.close();
+    if (summary != nullptr && execution_to_file)
+    {
+        *summary << "File content overwritten successfully." << std::endl;
+        *summary << "Output generated in " << execution_name << ".txt" << std::endl;
+    }
+
+    // The fairness report is part of the summary
+    if (summary != nullptr)
+    {
+        write_output(result.fairness, ("fairness" + name + ".csv").c_str(), summary);
+    }
+
+    // Paging and energy, when they are on
+    if (summary != nullptr)
+    {
+        *summary << print_run_summary(result, simulator.configuration());
+    }
+
+    if (summary != nullptr && pacer != nullptr)
+    {
+        *summary << "Replay (" << replay_speed << "x): " << pacer->lines() << " transitions, at most "
+                 << pacer->max_lag_ms() << " ms behind the wall clock" << std::endl;
+    }
+
+    if (SIM_PHASE_TIMERS)
+    {
+        std::cerr << print_phase_profile(result.profile, name.c_str());
+    }
+
+    // the outputs of a stuck run are written, but the run failed
+    return result.stuck.empty() ? 0 : -1;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file snapshot.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Dumps of the whole process table of a running Simulator
+ *
+ */
+
+#include <snapshot.hpp>
+
+#include <charconv>
+
+static const char SNAPSHOT_MAGIC[8] = {'S', 'I', 'M', 'S', 'N', 'A', 'P', '1'};
+
+// Room kept free in the buffer for one more row of any layout
+static const std::size_t SNAPSHOT_BUFFER = 1 << 20;
+static const std::size_t SNAPSHOT_ROW_MAX = 512;
+
+bool parse_snapshot_format(const std::string &name, snapshot_format &format)
+{
+    const char *names[] = {"table", "csv", "binary"};
+    for (int i = 0; i < 3; i++)
+    {
+        if (name == names[i])
+        {
+            format = (snapshot_format)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+snapshot_writer::snapshot_writer(const std::string &path, snapshot_format format)
+    : format(format), source(nullptr)
+{
+    output = (path == "-") ? stdout : std::fopen(path.c_str(), (format == SNAPSHOT_BINARY) ? "wb" : "w");
+    buffer.reserve(SNAPSHOT_BUFFER);
+
+    if (format == SNAPSHOT_CSV)
+    {
+        buffer += "time,PID,partition,size,arrival_time,start_time,remaining_time,state\n";
+    }
+    else if (format == SNAPSHOT_BINARY)
+    {
+        buffer.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    }
+}
+
+snapshot_writer::~snapshot_writer()
+{
+    if (output == nullptr)
+    {
+        return;
+    }
+    flush();
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+}
+
+void snapshot_writer::write(const Simulator &simulator)
+{
+    const process_table &table = simulator.processes();
+    unsigned int time = simulator.now();
+    uint32_t count = table.pcb.size();
+
+    if (format == SNAPSHOT_TABLE)
+    {
+        buffer += "Snapshot at ";
+        append_number(time);
+        buffer += "ms (";
+        append_number(count);
+        buffer += " processes)\n";
+        append_PCB_header(buffer);
+    }
+    else if (format == SNAPSHOT_BINARY)
+    {
+        snapshot_header header = {time, count};
+        buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        PCB program = get_PCB(table, i);
+        if (format == SNAPSHOT_TABLE)
+        {
+            append_PCB_row(buffer, program);
+        }
+        else if (format == SNAPSHOT_CSV)
+        {
+            append_csv_row(time, program);
+        }
+        else
+        {
+            snapshot_record record = {program.PID, program.partition_number, program.size, program.arrival_time,
+                                      program.start_time, program.remaining_time, (uint32_t)program.state};
+            buffer.append(reinterpret_cast<const char *>(&record), sizeof(record));
+        }
+        flush_if_full();
+    }
+
+    if (format == SNAPSHOT_TABLE)
+    {
+        append_PCB_footer(buffer);
+        buffer += '\n';
+    }
+    flush_if_full();
+}
+
+void snapshot_writer::on_transition(const sim_transition &transition)
+{
+    if (source != nullptr)
+    {
+        write(*source);
+    }
+}
+
+void snapshot_writer::append_csv_row(unsigned int time, const PCB &program)
+{
+    const char *state_names[] = {"NEW", "READY", "RUNNING", "WAITING", "TERMINATED", "NOT_ASSIGNED",
+                                 "SUSPENDED_READY", "SUSPENDED_WAITING"};
+
+    append_number(time);
+    buffer += ',';
+    append_number(program.PID);
+    buffer += ',';
+    append_number(program.partition_number);
+    buffer += ',';
+    append_number(program.size);
+    buffer += ',';
+    append_number(program.arrival_time);
+    buffer += ',';
+    append_number(program.start_time);
+    buffer += ',';
+    append_number(program.remaining_time);
+    buffer += ',';
+    buffer += state_names[program.state];
+    buffer += '\n';
+}
+
+void snapshot_writer::append_number(long long value)
+{
+    char digits[24];
+    char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+}
+
+void snapshot_writer::flush_if_full()
+{
+    if (buffer.size() >= SNAPSHOT_BUFFER - SNAPSHOT_ROW_MAX)
+    {
+        flush();
+    }
+}
+
+void snapshot_writer::flush()
+{
+    if (output != nullptr && !buffer.empty())
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), output);
+    }
+    buffer.clear();
+}
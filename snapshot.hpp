@@ -0,0 +1,80 @@
+/**
+ * @file snapshot.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Dumps of the whole process table of a running Simulator
+ *
+ * snapshot_writer writes the complete process table (every PCB, with the live fields from the table
+ * columns) whenever write() is called, e.g. at chosen simulated times by the scheduler programs, or
+ * after every transition when it is registered as an observer. Three layouts:
+ *  - SNAPSHOT_TABLE: "Snapshot at <time>ms" and the print_PCB table,
+ *  - SNAPSHOT_CSV: one header line, then time,PID,partition,size,arrival_time,start_time,
+ *    remaining_time,state per process and snapshot,
+ *  - SNAPSHOT_BINARY: "SIMSNAP1", then per snapshot a snapshot_header and count snapshot_records, in
+ *    native byte order.
+ * Rows are formatted with std::to_chars into a 1MB buffer, so a snapshot of a million processes costs
+ * about a tenth of a second and no more memory than the buffer.
+ */
+
+#ifndef SNAPSHOT_HPP_
+#define SNAPSHOT_HPP_
+
+#include <simulator.hpp>
+
+#include <cstdio>
+
+enum snapshot_format
+{
+    SNAPSHOT_TABLE,
+    SNAPSHOT_CSV,
+    SNAPSHOT_BINARY
+};
+
+// "table", "csv" or "binary"; returns false for anything else
+bool parse_snapshot_format(const std::string &name, snapshot_format &format);
+
+struct snapshot_header
+{
+    uint32_t time;
+    uint32_t count; // snapshot_records that follow
+};
+
+struct snapshot_record
+{
+    int32_t PID;
+    int32_t partition_number; // -1 when the process holds no partition
+    uint32_t size;
+    uint32_t arrival_time;
+    int32_t start_time;
+    uint32_t remaining_time;
+    uint32_t state; // states value
+};
+
+class snapshot_writer : public SimObserver
+{
+public:
+    // path "-" writes to stdout
+    snapshot_writer(const std::string &path, snapshot_format format);
+    ~snapshot_writer();
+
+    bool is_open() const { return output != nullptr; }
+
+    // Dumps the process table of simulator as it is now
+    void write(const Simulator &simulator);
+
+    // With a simulator set, write() is called for it after each of its transitions
+    void snapshot_transitions(const Simulator *simulator) { source = simulator; }
+    void on_transition(const sim_transition &transition) override;
+
+private:
+    void append_csv_row(unsigned int time, const PCB &program);
+    void append_number(long long value);
+    void flush_if_full();
+    void flush();
+
+    FILE *output;
+    snapshot_format format;
+    std::string buffer;
+    const Simulator *source;
+};
+
+#endif
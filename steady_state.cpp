@@ -0,0 +1,167 @@
+/**
+ * @file steady_state.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Runs a scheduler under a continuous open or closed loop load (see load_generator.hpp)
+ *
+ * The input trace is the job mix: every generated job is a copy of one of its lines, picked at
+ * random, arriving when the load model says. The rows of the sliding windows go to
+ * steady<SCHED>.csv and the summary with its confidence intervals to stdout.
+ *
+ * Usage: ./steady_state <RR | EP | EP_RR> <job_mix.txt | -> [options]
+ *
+ * Options:
+ *   --open RATE          Poisson arrivals, RATE jobs per second (the default, 10 jobs/s)
+ *   --closed N           N clients that each wait for their job and think before the next one
+ *   --think-ms N         ... for N ms on average (default 100)
+ *   --duration-ms N      simulated time (default 3600000)
+ *   --warmup-ms N        time before the statistics start (default 60000)
+ *   --window-ms N        time covered by a row and by a confidence interval batch (default 60000)
+ *   --slide-ms N         time between rows, divides the window (default: the window)
+ *   --max-live N         open loop: drop arrivals while N jobs are in the system (default 1000000)
+ *   --seed N             seed of the arrivals and the job choice (default 1)
+ *   --aging-ms N         aging interval of EP and EP_RR (default 0, off)
+ *   --quantum-ms N       time quantum of RR and EP_RR, 1 to 65535 (default 100)
+ *   --swap-out-ms N      swapping, as for the scheduler programs
+ *   --swap-in-ms N       ...
+ */
+
+#include <load_generator.hpp>
+
+#include <chrono>
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc % 2 == 0)
+    {
+        std::cout << "Usage: ./steady_state <RR | EP | EP_RR> <job_mix.txt | -> [options]" << std::endl;
+        return -1;
+    }
+
+    SimConfig config;
+    std::string name = argv[1];
+    if (name == "RR")
+        config.policy = ROUND_ROBIN;
+    else if (name == "EP")
+        config.policy = EXTERNAL_PRIORITY;
+    else if (name == "EP_RR")
+        config.policy = EXTERNAL_PRIORITY_RR;
+    else
+    {
+        std::cerr << "Error: unknown scheduler " << name << std::endl;
+        return -1;
+    }
+
+    load_config load;
+    bool slide_given = false;
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+        if (option == "--open")
+        {
+            load.model = OPEN_LOOP;
+            load.arrival_rate = std::stod(value);
+        }
+        else if (option == "--closed")
+        {
+            load.model = CLOSED_LOOP;
+            load.clients = std::stoul(value);
+        }
+        else if (option == "--think-ms")
+            load.think_time = std::stod(value);
+        else if (option == "--duration-ms")
+            load.duration = std::stoul(value);
+        else if (option == "--warmup-ms")
+            load.warmup = std::stoul(value);
+        else if (option == "--window-ms")
+            load.window = std::stoul(value);
+        else if (option == "--slide-ms")
+        {
+            load.slide = std::stoul(value);
+            slide_given = true;
+        }
+        else if (option == "--max-live")
+            load.max_live = std::stoul(value);
+        else if (option == "--seed")
+            load.seed = std::stoull(value);
+        else if (option == "--aging-ms")
+            config.aging_interval = std::stoul(value);
+        else if (option == "--quantum-ms")
+        {
+            unsigned long quantum = std::stoul(value);
+            if (quantum < 1 || quantum > MAX_TIME_QUANTUM)
+            {
+                std::cerr << "Error: --quantum-ms takes 1 to " << MAX_TIME_QUANTUM << " ms" << std::endl;
+                return -1;
+            }
+            config.time_quantum = quantum;
+        }
+        else if (option == "--swap-out-ms")
+        {
+            config.swapping = true;
+            config.swap_out_time = std::stoul(value);
+        }
+        else if (option == "--swap-in-ms")
+        {
+            config.swapping = true;
+            config.swap_in_time = std::stoul(value);
+        }
+        else
+        {
+            std::cerr << "Error: unknown option " << option << std::endl;
+            return -1;
+        }
+    }
+    if (!slide_given)
+    {
+        load.slide = load.window;
+    }
+
+    std::string file_name = argv[2];
+    std::ifstream input_file;
+    std::istream *input = &std::cin;
+    if (file_name != "-")
+    {
+        input_file.open(file_name);
+        if (!input_file.is_open())
+        {
+            std::cerr << "Error: Unable to open file: " << file_name << std::endl;
+            return -1;
+        }
+        input = &input_file;
+    }
+    std::vector<burst_run> bursts;
+    std::vector<PCB> mix;
+    try
+    {
+        mix = read_processes(*input, bursts);
+    }
+    catch (const std::invalid_argument &error)
+    {
+        std::cerr << "Error: " << file_name << ", " << error.what() << std::endl;
+        return -1;
+    }
+
+    std::string error;
+    if (!check_load_config(load, config, mix, error))
+    {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    std::string rows_name = "steady" + name + ".csv";
+    std::ofstream rows_file(rows_name, std::ios::trunc);
+    if (!rows_file.is_open())
+    {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    steady_state_result result = run_steady_state(config, load, mix, bursts, &rows_file);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << print_steady_state(result, load);
+    std::cout << load.duration << "ms simulated in " << seconds << "s, rows in " << rows_name << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file telemetry.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Periodic stats lines for a running Simulator
+ *
+ */
+
+#include <telemetry.hpp>
+
+telemetry_reporter::telemetry_reporter(const std::string &path, unsigned int interval_ms, const std::vector<memory_partition> &partitions)
+    : counters(partitions.size()), partitions(partitions), interval(std::max(1u, interval_ms)),
+      last_transitions(0), last_time(0), stopping(false)
+{
+    output = (path == "-") ? stderr : std::fopen(path.c_str(), "a");
+    started = std::chrono::steady_clock::now();
+    last_line = started;
+    if (output != nullptr)
+    {
+        reporter = std::thread(&telemetry_reporter::report_loop, this);
+    }
+}
+
+telemetry_reporter::~telemetry_reporter()
+{
+    if (reporter.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex);
+            stopping = true;
+        }
+        stop_signal.notify_one();
+        reporter.join();
+        write_line();
+    }
+    if (output != nullptr && output != stderr)
+    {
+        std::fclose(output);
+    }
+}
+
+void telemetry_reporter::report_loop()
+{
+    std::unique_lock<std::mutex> lock(stop_mutex);
+    while (!stop_signal.wait_for(lock, interval, [this]()
+                                 { return stopping; }))
+    {
+        write_line();
+    }
+}
+
+void telemetry_reporter::write_line()
+{
+    const char *state_names[] = {"new", "ready", "running", "waiting", "terminated", "not_arrived",
+                                 "suspended_ready", "suspended_waiting"};
+
+    auto now = std::chrono::steady_clock::now();
+    unsigned int time = counters.time.load(std::memory_order_relaxed);
+    unsigned long long transitions = counters.transitions.load(std::memory_order_relaxed);
+    double elapsed = std::chrono::duration<double>(now - last_line).count();
+    double events_per_second = (elapsed > 0) ? (transitions - last_transitions) / elapsed : 0;
+
+    std::string line;
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), "wall=%.1fs sim=%ums events=%llu events/s=%.0f ready=%u waiting=%u memory_wait=%u",
+                  std::chrono::duration<double>(now - started).count(), time, transitions, events_per_second,
+                  counters.ready.load(std::memory_order_relaxed), counters.waiting.load(std::memory_order_relaxed),
+                  counters.memory_waiting.load(std::memory_order_relaxed));
+    line += buffer;
+
+    // READY and WAITING are the queue depths above
+    for (int state : {NEW, RUNNING, TERMINATED, NOT_ASSIGNED, SUSPENDED_READY, SUSPENDED_WAITING})
+    {
+        std::snprintf(buffer, sizeof(buffer), " %s=%u", state_names[state], counters.in_state[state].load(std::memory_order_relaxed));
+        line += buffer;
+    }
+
+    line += " partitions=";
+    for (std::size_t i = 0; i < partitions.size(); i++)
+    {
+        int occupant = counters.partition_occupant[i].load(std::memory_order_relaxed);
+        line += (i > 0 ? "," : "") + std::to_string(partitions[i].partition_number) + ":" +
+                (occupant == -1 ? std::string("FREE") : std::to_string(occupant));
+    }
+
+    if (counters.finished.load(std::memory_order_relaxed))
+    {
+        line += " finished";
+    }
+    else if (time == last_time && now != started)
+    {
+        line += " stalled";
+    }
+
+    line += '\n';
+    std::fputs(line.c_str(), output);
+    std::fflush(output);
+
+    last_line = now;
+    last_transitions = transitions;
+    last_time = time;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file telemetry.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Periodic stats lines for a running Simulator
+ *
+ * A telemetry_reporter owns a sim_telemetry block (hand telemetry() to SimConfig::telemetry) and a
+ * thread that appends one line to a file every interval, e.g.
+ *
+ *   wall=12.0s sim=8405123ms events=1804420 events/s=150301 ready=37 waiting=12 memory_wait=4
+ *   new=4 running=1 terminated=1021 partitions=1:873,2:FREE,... 
+ *
+ * The line carries "stalled" when simulated time has not moved since the previous one. The simulation
+ * thread never blocks on the reporter, it only stores to the atomics.
+ */
+
+#ifndef TELEMETRY_HPP_
+#define TELEMETRY_HPP_
+
+#include <simulator.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class telemetry_reporter
+{
+public:
+    // path "-" writes to stderr
+    telemetry_reporter(const std::string &path, unsigned int interval_ms, const std::vector<memory_partition> &partitions);
+
+    // Writes a last line and stops the thread
+    ~telemetry_reporter();
+
+    sim_telemetry *telemetry() { return &counters; }
+    bool is_open() const { return output != nullptr; }
+
+private:
+    void report_loop();
+    void write_line();
+
+    sim_telemetry counters;
+    std::vector<memory_partition> partitions; // partition numbers for the line
+    FILE *output;
+    std::chrono::milliseconds interval;
+
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point last_line;
+    unsigned long long last_transitions;
+    unsigned int last_time;
+
+    std::mutex stop_mutex;
+    std::condition_variable stop_signal;
+    bool stopping;
+    std::thread reporter;
+};
+
+#endif
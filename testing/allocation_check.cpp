@@ -0,0 +1,100 @@
+/**
+ * @file allocation_check.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Checks that the simulation loop does not touch the heap once a run is under way
+ *
+ * Global operator new is replaced with a counting one. A generated trace is run through each
+ * scheduler with the execution table streamed to a discarding stream; the first tenth of the steps is
+ * warm-up, after that no transition may allocate. Prints the allocations of each phase of the run and
+ * exits 1 if the steady state allocated at all.
+ *
+ * Usage: ./allocation_check [processes] [seed]
+ */
+
+#include <simulator.hpp>
+#include <workload_generator.hpp>
+
+#include <cstdlib>
+#include <new>
+
+static unsigned long long allocation_count = 0;
+
+void *operator new(std::size_t size)
+{
+    allocation_count += 1;
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// Swallows the streamed execution table
+class null_buffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+};
+
+int main(int argc, char **argv)
+{
+    workload_config workload;
+    workload.count = (argc > 1) ? std::stoull(argv[1]) : 20000;
+    workload.seed = (argc > 2) ? std::stoull(argv[2]) : 4001;
+    workload.priorities = 4;
+    std::vector<PCB> processes = generate_processes(workload);
+
+    null_buffer discard;
+    std::ostream execution_output(&discard);
+
+    bool clean = true;
+    for (scheduling_policy policy : {ROUND_ROBIN, EXTERNAL_PRIORITY, EXTERNAL_PRIORITY_RR})
+    {
+        SimConfig config;
+        config.policy = policy;
+        config.execution_output = &execution_output;
+        Simulator simulator(config);
+
+        unsigned long long before_load = allocation_count;
+        simulator.load(processes);
+        unsigned long long load_allocations = allocation_count - before_load;
+
+        // warm-up: the first tenth of the run's steps, measured on a throwaway run
+        Simulator probe(config);
+        probe.load(processes);
+        unsigned long long warm_steps = std::max(1ULL, probe.run_until(UINT_MAX, ULLONG_MAX) / 10);
+
+        unsigned long long before_warm = allocation_count;
+        simulator.run_until(UINT_MAX, warm_steps);
+        unsigned long long warm_allocations = allocation_count - before_warm;
+        unsigned long long warm_transitions = simulator.transition_count();
+
+        unsigned long long before_steady = allocation_count;
+        simulator.run_until(UINT_MAX, ULLONG_MAX);
+        unsigned long long steady_allocations = allocation_count - before_steady;
+        unsigned long long steady_transitions = simulator.transition_count() - warm_transitions;
+        simulator.finish();
+
+        std::cout << std::left << std::setw(6) << policy_name(policy) << std::right
+                  << " load: " << load_allocations << " allocations, warm-up: " << warm_allocations
+                  << ", steady state: " << steady_allocations << " over " << steady_transitions << " transitions ("
+                  << (double)steady_allocations / std::max(1ULL, steady_transitions) << " per transition)" << std::endl;
+        if (steady_allocations > 0)
+        {
+            clean = false;
+        }
+    }
+
+    return clean ? 0 : 1;
+}
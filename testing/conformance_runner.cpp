@@ -0,0 +1,349 @@
+/**
+ * @file conformance_runner.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Runs every testing/testN case through all three schedulers in-process and diffs the goldens
+ *
+ * Every job runs its own Simulator with no SimConfig::log, so it prints nothing, and the cases are
+ * spread over a pool of threads. The output has to match executionRR.txt, executionEP.txt and
+ * executionEP_RR.txt byte for byte, and the first mismatching line of each failure is reported. Each case is also run a
+ * second time through a checkpoint and a fresh Simulator every 97 steps, and a third time forked from
+ * a shared prefix simulated under another policy, and a fourth time as the only shard of a sharded
+ * run (shards.hpp); all of them have to give the same output as the uninterrupted run.
+ *
+ * A case can carry an options.txt with the arguments the programs take after the input file: an
+ * aging interval, --check and the SimConfig options of parse_config_option(). Its report<SCHED>.txt
+ * golden, when there is one, holds what the programs print besides the tables: the trace issues, the
+ * processes of a stuck run and the paging and energy summaries. A trace the check rejects has a
+ * report and no execution golden. Paged cases skip the sharded run, whose shards bring their own
+ * partitions.
+ *
+ * Usage: ./conformance_runner [testing_dir] [threads]
+ */
+
+#include <shards.hpp>
+#include <trace_check.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+struct conformance_job
+{
+    std::string test_name;
+    scheduling_policy policy;
+    std::filesystem::path input;
+    std::filesystem::path golden;        // execution table, may not exist
+    std::filesystem::path report_golden; // report, may not exist
+    std::filesystem::path options;       // may not exist
+
+    bool passed;
+    std::string report; // first mismatch when the job failed
+};
+
+std::string read_file(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Describes the first line where actual differs from expected
+std::string first_mismatch(const std::string &expected, const std::string &actual)
+{
+    std::stringstream expected_lines(expected);
+    std::stringstream actual_lines(actual);
+    std::string expected_line;
+    std::string actual_line;
+    int line_number = 1;
+
+    while (true)
+    {
+        bool has_expected = (bool)std::getline(expected_lines, expected_line);
+        bool has_actual = (bool)std::getline(actual_lines, actual_line);
+        if (!has_expected && !has_actual)
+        {
+            // same lines, so the difference is in the final newline
+            return "line " + std::to_string(line_number) + ": trailing newline differs";
+        }
+        if (!has_expected || !has_actual || expected_line != actual_line)
+        {
+            return "line " + std::to_string(line_number) + ":\n      expected: " + (has_expected ? expected_line : "<end of file>") +
+                   "\n      actual:   " + (has_actual ? actual_line : "<end of file>");
+        }
+        line_number += 1;
+    }
+}
+
+// Number in a case name such as "test12", 0 if there is none
+int case_number(const std::string &test_name)
+{
+    std::size_t digits = test_name.find_first_of("0123456789");
+    return (digits == std::string::npos) ? 0 : std::stoi(test_name.substr(digits));
+}
+
+// Runs the simulation, hopping to a new Simulator through a checkpoint every 97 steps
+std::string run_resumed(const SimConfig &config, const std::vector<PCB> &list_process, const std::vector<burst_run> &bursts)
+{
+    auto simulator = std::make_unique<Simulator>(config);
+    simulator->load(list_process, bursts);
+
+    for (unsigned long long steps = 1; !simulator->finished() && !simulator->stuck(); steps++)
+    {
+        simulator->step();
+        if (steps % 97 == 0 || simulator->stuck())
+        {
+            // a stuck run also has to come back stuck, not idle for ever
+            bool stuck = simulator->stuck();
+            std::stringstream checkpoint;
+            simulator->save_checkpoint(checkpoint);
+            simulator = std::make_unique<Simulator>(config);
+            if (!simulator->load_checkpoint(checkpoint))
+            {
+                return "<checkpoint could not be loaded>";
+            }
+            if (simulator->stuck() != stuck)
+            {
+                return "<checkpoint of a stuck run resumed as not stuck>";
+            }
+        }
+    }
+    return simulator->finish().execution;
+}
+
+// Runs the policy-independent prefix as another policy, then forks into the job's policy
+std::string run_forked(const SimConfig &config, const std::vector<PCB> &list_process, const std::vector<burst_run> &bursts)
+{
+    SimConfig prefix_config = config;
+    prefix_config.policy = (config.policy == ROUND_ROBIN) ? EXTERNAL_PRIORITY : ROUND_ROBIN;
+    Simulator prefix(prefix_config);
+    prefix.load(list_process, bursts);
+    prefix.run_shared_prefix();
+
+    Simulator variant = prefix.fork(config);
+    while (!variant.finished() && !variant.stuck())
+    {
+        variant.step();
+    }
+    return variant.finish().execution;
+}
+
+// Runs the case as a single shard with the default partitions, through the merge of run_shards()
+std::string run_sharded(const SimConfig &config, const std::vector<PCB> &list_process, const std::vector<burst_run> &bursts)
+{
+    shard_spec everything;
+    everything.name = "all";
+    everything.partitions = default_partitions();
+    everything.catch_all = true;
+
+    std::stringstream execution;
+    SimResult result;
+    std::string error;
+    if (!run_shards(config, {everything}, list_process, bursts, 1, execution, result, error))
+    {
+        return "<" + error + ">";
+    }
+    return execution.str();
+}
+
+// Applies options.txt, the arguments of the programs after the input file, to config and mode
+bool read_options(const std::filesystem::path &path, SimConfig &config, trace_check_mode &mode, std::string &error)
+{
+    std::stringstream arguments(read_file(path));
+    std::string option;
+    while (arguments >> option)
+    {
+        std::string value;
+        if (option.rfind("--", 0) != 0)
+        {
+            config.aging_interval = std::stoul(option);
+            continue;
+        }
+        if (!(arguments >> value))
+        {
+            error = "missing value for " + option;
+            return false;
+        }
+        if (option == "--check")
+        {
+            if (!parse_trace_check_mode(value, mode))
+            {
+                error = "--check takes reject, clamp or report";
+                return false;
+            }
+        }
+        else if (!parse_config_option(option, value, config, error))
+        {
+            error = "unknown option " + option;
+            return false;
+        }
+        else if (!error.empty())
+        {
+            return false;
+        }
+    }
+    if (config.dvfs.governor != GOVERNOR_OFF && !check_dvfs_config(config.dvfs, error))
+    {
+        return false;
+    }
+    return true;
+}
+
+// Checks actual against the golden at path when the case has one
+bool matches_golden(const std::filesystem::path &path, const std::string &actual, const std::string &what, std::string &report)
+{
+    if (!std::filesystem::exists(path))
+    {
+        return true;
+    }
+    std::string expected = read_file(path);
+    if (actual != expected)
+    {
+        report = what + first_mismatch(expected, actual);
+        return false;
+    }
+    return true;
+}
+
+void run_job(conformance_job &job)
+{
+    SimConfig config;
+    config.policy = job.policy;
+    trace_check_config check;
+    std::string error;
+    if (std::filesystem::exists(job.options) && !read_options(job.options, config, check.mode, error))
+    {
+        job.passed = false;
+        job.report = job.options.string() + ": " + error;
+        return;
+    }
+
+    std::ifstream input_file(job.input);
+    check.largest_partition = largest_partition(config);
+    checked_trace trace = check_trace(input_file, check);
+    std::stringstream report;
+    print_trace_issues(trace, report);
+    if (!trace.accepted)
+    {
+        report << "rejected" << std::endl;
+        job.passed = matches_golden(job.report_golden, report.str(), "report, ", job.report);
+        if (job.passed && std::filesystem::exists(job.golden))
+        {
+            job.passed = false;
+            job.report = "the trace was rejected, but the case has an execution golden";
+        }
+        return;
+    }
+    const std::vector<PCB> &list_process = trace.processes;
+    const std::vector<burst_run> &bursts = trace.bursts;
+
+    SimResult result = Simulator(config).run(list_process, bursts);
+    if (!result.stuck.empty())
+    {
+        print_stuck(result, check.largest_partition, report);
+    }
+    report << print_run_summary(result, config);
+    job.passed = matches_golden(job.golden, result.execution, "", job.report) &&
+                 matches_golden(job.report_golden, report.str(), "report, ", job.report);
+    if (!job.passed)
+    {
+        return;
+    }
+
+    std::string resumed = run_resumed(config, list_process, bursts);
+    job.passed = (resumed == result.execution);
+    if (!job.passed)
+    {
+        job.report = "after checkpoint/resume, " + first_mismatch(result.execution, resumed);
+        return;
+    }
+
+    std::string forked = run_forked(config, list_process, bursts);
+    job.passed = (forked == result.execution);
+    if (!job.passed)
+    {
+        job.report = "after a fork, " + first_mismatch(result.execution, forked);
+        return;
+    }
+
+    if (config.frames == 0)
+    {
+        std::string sharded = run_sharded(config, list_process, bursts);
+        job.passed = (sharded == result.execution);
+        if (!job.passed)
+        {
+            job.report = "as a single shard, " + first_mismatch(result.execution, sharded);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::filesystem::path testing_dir = (argc > 1) ? argv[1] : "testing";
+    unsigned int thread_count = (argc > 2) ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    // Collect every (case, scheduler) pair that has a golden file
+    std::vector<conformance_job> jobs;
+    for (const auto &entry : std::filesystem::directory_iterator(testing_dir))
+    {
+        std::string test_name = entry.path().filename().string();
+        std::filesystem::path input = entry.path() / (test_name + ".txt");
+        if (!entry.is_directory() || !std::filesystem::exists(input))
+        {
+            continue;
+        }
+
+        for (scheduling_policy policy : {ROUND_ROBIN, EXTERNAL_PRIORITY, EXTERNAL_PRIORITY_RR})
+        {
+            std::filesystem::path golden = entry.path() / ("execution" + std::string(policy_name(policy)) + ".txt");
+            std::filesystem::path report_golden = entry.path() / ("report" + std::string(policy_name(policy)) + ".txt");
+            if (std::filesystem::exists(golden) || std::filesystem::exists(report_golden))
+            {
+                jobs.push_back({test_name, policy, input, golden, report_golden, entry.path() / "options.txt", false, ""});
+            }
+        }
+    }
+
+    if (jobs.empty())
+    {
+        std::cerr << "Error: no test cases found in " << testing_dir << std::endl;
+        return -1;
+    }
+
+    // Natural order (test2 before test10) for a stable report
+    std::sort(jobs.begin(), jobs.end(), [](const conformance_job &a, const conformance_job &b)
+              {
+                  if (case_number(a.test_name) != case_number(b.test_name))
+                      return case_number(a.test_name) < case_number(b.test_name);
+                  return a.policy < b.policy; });
+
+    std::atomic<std::size_t> next_job(0);
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < std::min<std::size_t>(thread_count, jobs.size()); i++)
+    {
+        workers.emplace_back([&jobs, &next_job]()
+                             {
+                                 for (std::size_t job = next_job++; job < jobs.size(); job = next_job++)
+                                 {
+                                     run_job(jobs[job]);
+                                 } });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    int failures = 0;
+    for (const auto &job : jobs)
+    {
+        if (!job.passed)
+        {
+            failures += 1;
+            std::cout << "FAIL " << job.test_name << " " << policy_name(job.policy) << " (" << job.input.parent_path().string() << ")\n    " << job.report << std::endl;
+        }
+    }
+
+    std::cout << jobs.size() - failures << "/" << jobs.size() << " golden outputs match" << std::endl;
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file timeseries.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Time series of the load of a running Simulator: CPU, queue lengths, memory in use
+ *
+ */
+
+#include <timeseries.hpp>
+
+#include <charconv>
+
+static const char TIMESERIES_MAGIC[8] = {'S', 'I', 'M', 'T', 'S', '1', '\0', '\0'};
+
+// Rows per columnar block, and CSV text written out at once
+static const uint32_t BLOCK_ROWS = 4096;
+static const std::size_t CSV_BUFFER = 1 << 16;
+
+// uint32 columns of a block, in file order (cpu_busy follows as uint8)
+enum timeseries_column
+{
+    COLUMN_TIME,
+    COLUMN_LENGTH,
+    COLUMN_READY,
+    COLUMN_WAITING,
+    COLUMN_MEMORY_WAITING,
+    COLUMN_SUSPENDED,
+    COLUMN_MEMORY_USED,
+    COLUMN_MEMORY_UNITS,
+    COLUMN_COUNT
+};
+
+bool parse_timeseries_format(const std::string &name, timeseries_format &format)
+{
+    if (name == "csv")
+        format = TIMESERIES_CSV;
+    else if (name == "columnar")
+        format = TIMESERIES_COLUMNAR;
+    else
+        return false;
+    return true;
+}
+
+timeseries_writer::timeseries_writer(const std::string &path, timeseries_format format, unsigned int interval)
+    : format(format), interval(interval)
+{
+    output = (path == "-") ? stdout : std::fopen(path.c_str(), (format == TIMESERIES_COLUMNAR) ? "wb" : "w");
+    if (format == TIMESERIES_CSV)
+    {
+        buffer.reserve(CSV_BUFFER + 256);
+        buffer += "time,length,cpu_busy,ready,waiting,memory_waiting,suspended,memory_used,memory_units\n";
+    }
+    else
+    {
+        columns.resize(COLUMN_COUNT * BLOCK_ROWS);
+        busy_column.resize(BLOCK_ROWS);
+        if (output != nullptr)
+        {
+            std::fwrite(TIMESERIES_MAGIC, 1, sizeof(TIMESERIES_MAGIC), output);
+        }
+    }
+}
+
+timeseries_writer::~timeseries_writer()
+{
+    if (output == nullptr)
+    {
+        return;
+    }
+    if (format == TIMESERIES_CSV)
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), output);
+    }
+    else
+    {
+        write_block();
+    }
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+}
+
+void timeseries_writer::finish(unsigned int end_time)
+{
+    if (interval == 0 && pending_valid && end_time > pending_time)
+    {
+        append(pending_time, end_time - pending_time, pending);
+    }
+    pending_valid = false;
+}
+
+void timeseries_writer::append(unsigned int time, unsigned int length, const sim_load &load)
+{
+    written += 1;
+    if (format == TIMESERIES_COLUMNAR)
+    {
+        uint32_t *row = columns.data() + block_rows;
+        row[COLUMN_TIME * BLOCK_ROWS] = time;
+        row[COLUMN_LENGTH * BLOCK_ROWS] = length;
+        row[COLUMN_READY * BLOCK_ROWS] = load.ready;
+        row[COLUMN_WAITING * BLOCK_ROWS] = load.waiting;
+        row[COLUMN_MEMORY_WAITING * BLOCK_ROWS] = load.memory_waiting;
+        row[COLUMN_SUSPENDED * BLOCK_ROWS] = load.suspended;
+        row[COLUMN_MEMORY_USED * BLOCK_ROWS] = load.memory_used;
+        row[COLUMN_MEMORY_UNITS * BLOCK_ROWS] = load.memory_units;
+        busy_column[block_rows] = load.cpu_busy;
+        block_rows += 1;
+        if (block_rows == BLOCK_ROWS)
+        {
+            write_block();
+        }
+        return;
+    }
+
+    uint32_t values[] = {time, length, load.cpu_busy, load.ready, load.waiting, load.memory_waiting, load.suspended,
+                         load.memory_used, load.memory_units};
+    char line[128];
+    char *end = line;
+    for (uint32_t value : values)
+    {
+        end = std::to_chars(end, line + sizeof(line), value).ptr;
+        *end++ = ',';
+    }
+    end[-1] = '\n';
+    buffer.append(line, end);
+    if (buffer.size() >= CSV_BUFFER)
+    {
+        if (output != nullptr)
+        {
+            std::fwrite(buffer.data(), 1, buffer.size(), output);
+        }
+        buffer.clear();
+    }
+}
+
+// Writes the rows of the current block column by column
+void timeseries_writer::write_block()
+{
+    if (block_rows == 0)
+    {
+        return;
+    }
+    if (output != nullptr)
+    {
+        std::fwrite(&block_rows, sizeof(block_rows), 1, output);
+        for (int column = 0; column < COLUMN_COUNT; column++)
+        {
+            std::fwrite(columns.data() + column * BLOCK_ROWS, sizeof(uint32_t), block_rows, output);
+        }
+        std::fwrite(busy_column.data(), 1, block_rows, output);
+    }
+    block_rows = 0;
+}
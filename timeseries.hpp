@@ -0,0 +1,100 @@
+/**
+ * @file timeseries.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Time series of the load of a running Simulator: CPU, queue lengths, memory in use
+ *
+ * With SimConfig::timeseries set, the Simulator hands the writer its sim_load once per simulated ms,
+ * after dispatching (so a sample shows the ms the CPU is about to run). The values come from the
+ * counters the loop keeps anyway (queue sizes, processes per state, memory in use), so a sample is
+ * O(1) whatever the number of processes. The writer keeps
+ *  - every interval-th ms (a grid), each row holding for interval ms, or
+ *  - with interval 0, only the changes: a row is written when the values change, with the number of
+ *    ms they held (run-length compression of the per-ms series).
+ * Rows are either CSV or columnar blocks: "SIMTS1\0\0", then blocks of up to 4096 rows, each a
+ * uint32 row count followed by one array per column (time, length, ready, waiting, memory_waiting,
+ * suspended, memory_used, memory_units as uint32, then cpu_busy as uint8), in native byte order. A
+ * column of a block can be read with one seek, and the blocks keep the memory of the writer fixed.
+ */
+
+#ifndef TIMESERIES_HPP_
+#define TIMESERIES_HPP_
+
+#include <simulator.hpp>
+
+#include <cstdio>
+
+enum timeseries_format
+{
+    TIMESERIES_CSV,
+    TIMESERIES_COLUMNAR
+};
+
+// "csv" or "columnar"; returns false for anything else
+bool parse_timeseries_format(const std::string &name, timeseries_format &format);
+
+class timeseries_writer
+{
+public:
+    // path "-" writes to stdout; interval 0 writes on change
+    timeseries_writer(const std::string &path, timeseries_format format, unsigned int interval);
+    ~timeseries_writer();
+
+    bool is_open() const { return output != nullptr; }
+
+    // The load during the ms starting at time, called for every ms in order
+    void sample(unsigned int time, const sim_load &load)
+    {
+        if (interval > 0)
+        {
+            if (time >= next_time)
+            {
+                append(time, interval, load);
+                next_time = (time / interval + 1) * (unsigned long long)interval;
+            }
+        }
+        else if (!pending_valid || !same_load(load, pending))
+        {
+            if (pending_valid)
+            {
+                append(pending_time, time - pending_time, pending);
+            }
+            pending = load;
+            pending_time = time;
+            pending_valid = true;
+        }
+    }
+
+    // The run ended at end_time: writes the last run of an on-change series
+    void finish(unsigned int end_time);
+
+    unsigned long long rows() const { return written; }
+
+private:
+    static bool same_load(const sim_load &a, const sim_load &b)
+    {
+        return a.cpu_busy == b.cpu_busy && a.ready == b.ready && a.waiting == b.waiting &&
+               a.memory_waiting == b.memory_waiting && a.suspended == b.suspended &&
+               a.memory_used == b.memory_used && a.memory_units == b.memory_units;
+    }
+
+    void append(unsigned int time, unsigned int length, const sim_load &load);
+    void write_block();
+
+    FILE *output;
+    timeseries_format format;
+    unsigned int interval;
+    unsigned long long next_time = 0;
+
+    // on change: the run not written yet
+    sim_load pending;
+    unsigned int pending_time = 0;
+    bool pending_valid = false;
+
+    std::string buffer;            // CSV text not written yet
+    std::vector<uint32_t> columns; // columnar: the current block, BLOCK_ROWS entries per uint32 column
+    std::vector<uint8_t> busy_column;
+    uint32_t block_rows = 0;
+    unsigned long long written = 0;
+};
+
+#endif
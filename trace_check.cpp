@@ -0,0 +1,212 @@
+/**
+ * @file trace_check.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Checks an input trace against what the simulator can run, in the same pass that parses it
+ *
+ */
+
+#include <trace_check.hpp>
+
+bool parse_trace_check_mode(const std::string &name, trace_check_mode &mode)
+{
+    if (name == "reject")
+        mode = CHECK_REJECT;
+    else if (name == "clamp")
+        mode = CHECK_CLAMP;
+    else if (name == "report")
+        mode = CHECK_REPORT;
+    else
+        return false;
+    return true;
+}
+
+unsigned int largest_partition(const SimConfig &config)
+{
+    unsigned int largest = 0;
+    if (config.frames == 0)
+    {
+        for (const auto &partition : config.partitions)
+        {
+            largest = std::max(largest, partition.size);
+        }
+    }
+    return largest;
+}
+
+// Counts an issue, keeping it in issues while there are fewer than max_issues (detail() is only
+// called then)
+template <typename Detail>
+static void add_issue(checked_trace &trace, std::vector<trace_issue> &issues, const trace_check_config &config,
+                      unsigned long long line, trace_issue_kind kind, Detail detail)
+{
+    trace.issue_counts[kind] += 1;
+    if (issues.size() < config.max_issues)
+    {
+        issues.push_back({line, kind, detail()});
+    }
+}
+
+checked_trace check_trace(std::istream &input, const trace_check_config &config)
+{
+    checked_trace trace;
+    bool clamp = (config.mode == CHECK_CLAMP);
+    bool by_arrival = true; // the processes so far are sorted by arrival time
+    bool by_pid = true;     // ... and by strictly increasing PID
+
+    for_each_line(input, [&](unsigned long long line, const char *begin, const char *end)
+                  {
+                      if (is_blank(begin, end))
+                      {
+                          return;
+                      }
+                      PCB process;
+                      if (!parse_process_line(begin, end, process, trace.bursts))
+                      {
+                          std::string text(begin, std::min<std::size_t>(end - begin, 80));
+                          add_issue(trace, trace.issues, config, line, ISSUE_MALFORMED, [&]
+                                    { return "malformed, \"" + text + "\""; });
+                          return;
+                      }
+
+                      if (config.largest_partition > 0 && process.size > config.largest_partition)
+                      {
+                          add_issue(trace, trace.issues, config, line, ISSUE_TOO_LARGE, [&]
+                                    { return "PID " + std::to_string(process.PID) + " needs " + std::to_string(process.size) +
+                                             "MB, the largest partition is " + std::to_string(config.largest_partition) + "MB"; });
+                          if (clamp)
+                          {
+                              process.size = config.largest_partition;
+                          }
+                      }
+                      if (process.processing_time == 0)
+                      {
+                          add_issue(trace, trace.issues, config, line, ISSUE_ZERO_CPU, [&]
+                                    { return "PID " + std::to_string(process.PID) + " has no CPU time"; });
+                          if (clamp)
+                          {
+                              process.processing_time = process.remaining_time = 1;
+                          }
+                      }
+
+                      if (!trace.processes.empty())
+                      {
+                          by_arrival = by_arrival && trace.processes.back().arrival_time <= process.arrival_time;
+                          by_pid = by_pid && trace.processes.back().PID < process.PID;
+                      }
+                      trace.processes.push_back(process);
+                      trace.lines.push_back(line);
+                  });
+
+    std::size_t count = trace.processes.size();
+    trace.pid_index.reserve(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        trace.pid_index.push_back({trace.processes[i].PID, i});
+    }
+    if (!by_pid)
+    {
+        std::sort(trace.pid_index.begin(), trace.pid_index.end());
+
+        // Every process after the first (in input order) with the same PID is a duplicate
+        std::vector<trace_issue> issues;
+        std::vector<uint32_t> duplicates;
+        uint32_t first = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            uint32_t process = trace.pid_index[i].second;
+            if (i == 0 || trace.pid_index[i].first != trace.pid_index[i - 1].first)
+            {
+                first = process;
+                continue;
+            }
+            duplicates.push_back(process);
+            add_issue(trace, issues, config, trace.lines[process], ISSUE_DUPLICATE_PID, [&]
+                      { return "PID " + std::to_string(trace.processes[process].PID) + " is already used on line " +
+                               std::to_string(trace.lines[first]); });
+        }
+
+        // The duplicates were found after the pass, merge them in line order
+        std::sort(issues.begin(), issues.end(), [](const trace_issue &a, const trace_issue &b)
+                  { return a.line < b.line; });
+        std::size_t pass_issues = trace.issues.size();
+        trace.issues.insert(trace.issues.end(), issues.begin(), issues.end());
+        std::inplace_merge(trace.issues.begin(), trace.issues.begin() + pass_issues, trace.issues.end(),
+                           [](const trace_issue &a, const trace_issue &b)
+                           { return a.line < b.line; });
+        if (trace.issues.size() > config.max_issues)
+        {
+            trace.issues.resize(config.max_issues);
+        }
+
+        // Clamping gives the duplicates fresh PIDs above every other one, in input order
+        long long next_pid = (long long)trace.pid_index.back().first + 1;
+        if (clamp && !duplicates.empty() && next_pid + (long long)duplicates.size() - 1 > INT32_MAX)
+        {
+            trace.accepted = false; // no PIDs left above the others, the index stays as it is
+        }
+        else if (clamp && !duplicates.empty())
+        {
+            std::sort(duplicates.begin(), duplicates.end());
+            trace.pid_index.erase(std::remove_if(trace.pid_index.begin(), trace.pid_index.end(), [&](const auto &entry)
+                                                 { return std::binary_search(duplicates.begin(), duplicates.end(), entry.second); }),
+                                  trace.pid_index.end());
+            for (uint32_t process : duplicates)
+            {
+                trace.processes[process].PID = (int)next_pid;
+                trace.pid_index.push_back({(int)next_pid, process});
+                next_pid += 1;
+            }
+        }
+    }
+
+    trace.arrival_order.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        trace.arrival_order[i] = i;
+    }
+    if (!by_arrival)
+    {
+        std::stable_sort(trace.arrival_order.begin(), trace.arrival_order.end(), [&trace](uint32_t a, uint32_t b)
+                         { return trace.processes[a].arrival_time < trace.processes[b].arrival_time; });
+    }
+
+    if (config.mode == CHECK_REJECT)
+    {
+        for (auto issues : trace.issue_counts)
+        {
+            trace.accepted = trace.accepted && issues == 0;
+        }
+    }
+    return trace;
+}
+
+uint32_t find_pid(const checked_trace &trace, int PID)
+{
+    auto entry = std::lower_bound(trace.pid_index.begin(), trace.pid_index.end(), std::make_pair(PID, (uint32_t)0));
+    return (entry != trace.pid_index.end() && entry->first == PID) ? entry->second : NO_PROCESS;
+}
+
+void print_trace_issues(const checked_trace &trace, std::ostream &output)
+{
+    const char *kind_names[] = {"malformed lines", "duplicate PIDs", "processes larger than any partition",
+                                "processes without CPU time"};
+    for (const auto &issue : trace.issues)
+    {
+        output << "line " << issue.line << ": " << issue.detail << std::endl;
+    }
+
+    unsigned long long total = 0;
+    for (auto issues : trace.issue_counts)
+    {
+        total += issues;
+    }
+    if (total > trace.issues.size())
+    {
+        output << "... " << total - trace.issues.size() << " more:";
+        for (int kind = 0; kind < ISSUE_KIND_COUNT; kind++)
+        {
+            output << " " << trace.issue_counts[kind] << " " << kind_names[kind] << (kind + 1 < ISSUE_KIND_COUNT ? "," : "");
+        }
+        output << " in all" << std::endl;
+    }
+}
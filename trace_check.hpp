@@ -0,0 +1,82 @@
+/**
+ * @file trace_check.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Checks an input trace against what the simulator can run, in the same pass that parses it
+ *
+ * read_processes() only checks the syntax. A trace can be well formed and still break a run:
+ *  - a duplicate PID: partitions are freed by PID, so one of the two frees the other's partition
+ *  - a size above the largest partition: the process waits for memory for ever and the run never ends
+ *  - a CPU time of 0: the first ms it runs wraps its remaining time around to 4 billion ms
+ * check_trace() parses the trace and checks every line as it goes, and then, depending on the mode:
+ *  - reject: refuses the trace if anything is wrong (malformed lines included)
+ *  - clamp:  fixes what it can (a fresh PID above the others, the size of the largest partition, 1ms of
+ *            CPU) and drops the malformed lines
+ *  - report: loads the trace as it is, dropping only the malformed lines
+ * Every issue carries its input line. The pass also hands the simulator its arrival order and a PID
+ * index. A trace already sorted by arrival time (or by PID) is noticed while reading, and then not
+ * sorted again.
+ */
+
+#ifndef TRACE_CHECK_HPP_
+#define TRACE_CHECK_HPP_
+
+#include <simulator.hpp>
+
+enum trace_check_mode
+{
+    CHECK_REJECT,
+    CHECK_CLAMP,
+    CHECK_REPORT
+};
+
+// "reject", "clamp" or "report"; returns false for anything else
+bool parse_trace_check_mode(const std::string &name, trace_check_mode &mode);
+
+enum trace_issue_kind
+{
+    ISSUE_MALFORMED,
+    ISSUE_DUPLICATE_PID,
+    ISSUE_TOO_LARGE,
+    ISSUE_ZERO_CPU,
+    ISSUE_KIND_COUNT
+};
+
+struct trace_issue
+{
+    unsigned long long line;
+    trace_issue_kind kind;
+    std::string detail;
+};
+
+struct trace_check_config
+{
+    trace_check_mode mode = CHECK_REJECT;
+    unsigned int largest_partition = 0; // MB, 0 = no limit (paged memory)
+    std::size_t max_issues = 100;       // issues kept with their details, the rest are only counted
+};
+
+struct checked_trace
+{
+    std::vector<PCB> processes;
+    std::vector<burst_run> bursts;
+    std::vector<unsigned long long> lines;          // input line of each process
+    std::vector<uint32_t> arrival_order;            // as arrival_order() of its process table
+    std::vector<std::pair<int, uint32_t>> pid_index; // (PID, process) sorted by PID, PID ties by process
+
+    std::vector<trace_issue> issues; // the first max_issues, in line order
+    unsigned long long issue_counts[ISSUE_KIND_COUNT] = {};
+    bool accepted = true; // false when the mode is reject and there was an issue
+};
+
+// The largest partition of a simulator configuration, 0 with paged memory
+unsigned int largest_partition(const SimConfig &config);
+
+checked_trace check_trace(std::istream &input, const trace_check_config &config);
+
+// Index of the (first) process with PID, NO_PROCESS if there is none
+uint32_t find_pid(const checked_trace &trace, int PID);
+
+// "line N: what" for every kept issue, then the counts of the ones past max_issues
+void print_trace_issues(const checked_trace &trace, std::ostream &output);
+
+#endif
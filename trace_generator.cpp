@@ -0,0 +1,123 @@
+/**
+ * @file trace_generator.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Command line front end of workload_generator.hpp
+ *
+ * Writes a reproducible trace to stdout (or -o <file>), e.g.
+ *   ./trace_generator --count 10000000 --seed 7 -o big.txt
+ *   ./trace_generator --count 1000 --io-ratio 0.8 | ./interrupts_EP -
+ */
+
+#include <workload_generator.hpp>
+
+void print_usage()
+{
+    std::cout << "Usage: ./trace_generator [options]\n"
+              << "  --count N             number of processes (default 1000)\n"
+              << "  --seed N              random seed (default 4001)\n"
+              << "  --arrival-rate R      Poisson arrivals per ms, 0 = all at time 0 (default 0.01)\n"
+              << "  --burst-alpha A       Pareto shape of the CPU burst (default 1.5)\n"
+              << "  --burst-min N         shortest CPU burst in ms (default 10)\n"
+              << "  --burst-max N         cap on the CPU burst in ms (default 5000)\n"
+              << "  --io-ratio P          fraction of processes doing I/O (default 0.5)\n"
+              << "  --io-freq MIN,MAX     io_freq range for I/O processes (default 5,100)\n"
+              << "  --io-duration-mean M  exponential mean of io_duration (default 20)\n"
+              << "  --size-mix W1,...,W6  weight per memory partition, largest first (default 1,1,1,1,1,1)\n"
+              << "  --priorities K        add a priority column in [1, K] (default off)\n"
+              << "  -o FILE               write to FILE instead of stdout" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    workload_config config;
+    const char *output_name = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "-h" || option == "--help")
+        {
+            print_usage();
+            return 0;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Error: missing value for " << option << std::endl;
+            print_usage();
+            return -1;
+        }
+        std::string value = argv[++i];
+
+        if (option == "--count")
+            config.count = std::stoull(value);
+        else if (option == "--seed")
+            config.seed = std::stoull(value);
+        else if (option == "--arrival-rate")
+            config.arrival_rate = std::stod(value);
+        else if (option == "--burst-alpha")
+            config.burst_alpha = std::stod(value);
+        else if (option == "--burst-min")
+            config.burst_min = std::stoul(value);
+        else if (option == "--burst-max")
+            config.burst_max = std::stoul(value);
+        else if (option == "--io-ratio")
+            config.io_ratio = std::stod(value);
+        else if (option == "--io-freq")
+        {
+            auto range = split_delim(value, ",");
+            config.io_freq_min = std::stoul(range[0]);
+            config.io_freq_max = std::stoul(range.back());
+        }
+        else if (option == "--io-duration-mean")
+            config.io_duration_mean = std::stod(value);
+        else if (option == "--size-mix")
+        {
+            config.size_mix.clear();
+            for (const auto &weight : split_delim(value, ","))
+            {
+                config.size_mix.push_back(std::stod(weight));
+            }
+        }
+        else if (option == "--priorities")
+            config.priorities = std::stoul(value);
+        else if (option == "-o")
+            output_name = argv[i];
+        else
+        {
+            std::cerr << "Error: unknown option " << option << std::endl;
+            print_usage();
+            return -1;
+        }
+    }
+
+    if (config.burst_alpha <= 0 || config.burst_min == 0)
+    {
+        std::cerr << "Error: --burst-alpha and --burst-min must be positive" << std::endl;
+        return -1;
+    }
+
+    FILE *output = stdout;
+    if (output_name != nullptr)
+    {
+        output = std::fopen(output_name, "w");
+        if (output == nullptr)
+        {
+            std::cerr << "Error: Unable to open file: " << output_name << std::endl;
+            return -1;
+        }
+    }
+
+    bool written = write_workload(config, output);
+    if (output != stdout)
+    {
+        written = (std::fclose(output) == 0) && written;
+    }
+
+    if (!written)
+    {
+        std::cerr << "Error writing trace" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file what_if.cpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Runs RR, EP and EP_RR on one trace from a shared prefix
+ *
+ * The trace is parsed once and simulated up to the first step where the policies could disagree
+ * (Simulator::run_shared_prefix()); that state is forked into the three schedulers, which finish
+ * on their own threads. The output files are the ones the three scheduler programs would write.
+ *
+ * Usage: ./what_if <input_file.txt | -> [aging_interval_ms]
+ */
+
+#include <simulator.hpp>
+
+#include <chrono>
+#include <thread>
+
+struct what_if_run
+{
+    Simulator simulator;
+    SimResult result;
+    double seconds;
+};
+
+int main(int argc, char **argv)
+{
+    if (argc != 2 && argc != 3)
+    {
+        std::cout << "Usage: ./what_if <input_file.txt | -> [aging_interval_ms]" << std::endl;
+        return -1;
+    }
+
+    std::string file_name = argv[1];
+    std::ifstream input_file;
+    std::istream *input = &std::cin;
+    if (file_name != "-")
+    {
+        input_file.open(file_name);
+        if (!input_file.is_open())
+        {
+            std::cerr << "Error: Unable to open file: " << file_name << std::endl;
+            return -1;
+        }
+        input = &input_file;
+    }
+
+    SimConfig config;
+    config.aging_interval = (argc == 3) ? std::stoi(argv[2]) : 0;
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator prefix(config);
+    std::vector<burst_run> bursts;
+    std::vector<PCB> processes;
+    try
+    {
+        processes = read_processes(*input, bursts);
+    }
+    catch (const std::invalid_argument &error)
+    {
+        std::cerr << "Error: " << file_name << ", " << error.what() << std::endl;
+        return -1;
+    }
+    prefix.load(processes, bursts);
+    prefix.run_shared_prefix();
+    double prefix_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "shared prefix: " << prefix.now() << "ms simulated in " << prefix_seconds << "s" << std::endl;
+
+    std::vector<what_if_run> runs;
+    for (scheduling_policy policy : {ROUND_ROBIN, EXTERNAL_PRIORITY, EXTERNAL_PRIORITY_RR})
+    {
+        SimConfig variant = config;
+        variant.policy = policy;
+        runs.push_back({prefix.fork(variant), SimResult(), 0});
+    }
+
+    std::vector<std::thread> workers;
+    for (auto &run : runs)
+    {
+        workers.emplace_back([&run]()
+                             {
+                                 auto begin = std::chrono::steady_clock::now();
+                                 while (!run.simulator.finished() && !run.simulator.stuck())
+                                 {
+                                     run.simulator.step();
+                                 }
+                                 run.result = run.simulator.finish();
+                                 run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (auto &run : runs)
+    {
+        std::string name = policy_name(run.simulator.configuration().policy);
+        std::cout << std::left << std::setw(6) << name << std::right << " finished at " << run.result.end_time
+                  << "ms, " << run.result.transitions << " transitions, " << run.seconds << "s after the fork" << std::endl;
+        if (!run.result.stuck.empty())
+        {
+            std::cout << "       stuck: " << run.result.stuck.size() << " processes never fit in memory" << std::endl;
+        }
+        write_output(run.result.execution, ("execution" + name + ".txt").c_str());
+        write_output(run.result.fairness, ("fairness" + name + ".csv").c_str());
+        if (SIM_PHASE_TIMERS)
+        {
+            std::cerr << print_phase_profile(run.result.profile, name.c_str());
+        }
+    }
+
+    return 0;
+}
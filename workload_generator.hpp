@@ -0,0 +1,224 @@
+/**
+ * @file workload_generator.hpp
+ * @author Aydan Eng, Eric Cui
+ * @brief Reproducible synthetic workloads in the simulator input format
+ *
+ * Processes are drawn one at a time from a seeded generator, so a trace of any length can be streamed
+ * to a file or pipe, or handed straight to the simulator as PCBs. The distributions are implemented
+ * here on top of std::mt19937_64 (instead of the <random> distributions, whose output differs between
+ * standard libraries) so the same seed gives the same trace everywhere.
+ */
+
+#ifndef WORKLOAD_GENERATOR_HPP_
+#define WORKLOAD_GENERATOR_HPP_
+
+#include <interrupts_AydanEng_EricCui.hpp>
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+struct workload_config
+{
+    unsigned long long count = 1000; // number of processes
+    unsigned long long seed = 4001;
+
+    double arrival_rate = 0.01; // Poisson arrivals per ms, 0 puts every arrival at time 0
+
+    double burst_alpha = 1.5;     // Pareto shape of the CPU burst, smaller = heavier tail
+    unsigned int burst_min = 10;  // Pareto scale (the shortest burst)
+    unsigned int burst_max = 5000; // cap on the tail
+
+    double io_ratio = 0.5;          // fraction of processes that do I/O at all
+    unsigned int io_freq_min = 5;   // uniform range of io_freq for I/O processes
+    unsigned int io_freq_max = 100;
+    double io_duration_mean = 20;   // exponential mean of io_duration
+
+    // Relative weight of each memory_partitions entry (same order); a process picked for a partition
+    // gets a size that fits it but not the next smaller one
+    std::vector<double> size_mix = {1, 1, 1, 1, 1, 1};
+
+    unsigned int priorities = 0; // > 0 adds a priority column drawn uniformly from [1, priorities]
+};
+
+// One generated input line
+struct generated_process
+{
+    int PID;
+    unsigned int size;
+    unsigned int arrival_time;
+    unsigned int processing_time;
+    unsigned int io_freq;
+    unsigned int io_duration;
+    int priority; // 0 when the config has no priority classes
+};
+
+struct workload_generator
+{
+    workload_config config;
+    std::mt19937_64 rng;
+    double clock;                    // arrival clock in ms
+    unsigned long long generated;    // processes produced so far
+    std::vector<double> size_cumulative; // cumulative size_mix weights
+    std::vector<unsigned int> size_low;  // smallest size that still needs each partition
+};
+
+inline workload_generator make_workload_generator(const workload_config &config)
+{
+    workload_generator generator;
+    generator.config = config;
+    generator.rng.seed(config.seed);
+    generator.clock = 0;
+    generator.generated = 0;
+
+    double total = 0;
+    for (int i = 0; i < 6; i++)
+    {
+        total += (i < (int)config.size_mix.size()) ? config.size_mix[i] : 0;
+        generator.size_cumulative.push_back(total);
+
+        // next smaller partition bounds the size from below
+        unsigned int low = 1;
+        for (int j = 0; j < 6; j++)
+        {
+            if (memory_partitions[j].size < memory_partitions[i].size)
+            {
+                low = std::max(low, memory_partitions[j].size + 1);
+            }
+        }
+        generator.size_low.push_back(low);
+    }
+
+    return generator;
+}
+
+// Uniform double in [0, 1) from the top 53 bits
+inline double uniform01(workload_generator &generator)
+{
+    return (generator.rng() >> 11) * 0x1.0p-53;
+}
+
+// Uniform integer in [low, high]
+inline unsigned int uniform_int(workload_generator &generator, unsigned int low, unsigned int high)
+{
+    if (high <= low)
+    {
+        return low;
+    }
+    return low + (unsigned int)(uniform01(generator) * (high - low + 1));
+}
+
+inline double exponential(workload_generator &generator, double mean)
+{
+    return -mean * std::log1p(-uniform01(generator));
+}
+
+inline generated_process next_process(workload_generator &generator)
+{
+    const workload_config &config = generator.config;
+    generated_process process;
+
+    generator.generated += 1;
+    process.PID = (int)generator.generated;
+
+    if (config.arrival_rate > 0)
+    {
+        generator.clock += exponential(generator, 1.0 / config.arrival_rate);
+    }
+    process.arrival_time = (unsigned int)generator.clock;
+
+    // Pareto burst, capped so one draw cannot stall a whole run
+    double burst = config.burst_min / std::pow(1.0 - uniform01(generator), 1.0 / config.burst_alpha);
+    process.processing_time = (unsigned int)std::max(1.0, std::min(burst, (double)config.burst_max));
+
+    // Pick the partition class, then a size that needs that partition
+    int partition = 0;
+    double pick = uniform01(generator) * generator.size_cumulative.back();
+    while (partition < 5 && pick >= generator.size_cumulative[partition])
+    {
+        partition += 1;
+    }
+    process.size = uniform_int(generator, generator.size_low[partition], memory_partitions[partition].size);
+
+    if (uniform01(generator) < config.io_ratio)
+    {
+        process.io_freq = uniform_int(generator, config.io_freq_min, config.io_freq_max);
+        process.io_duration = (unsigned int)std::max(1.0, std::round(exponential(generator, config.io_duration_mean)));
+    }
+    else
+    {
+        process.io_freq = 0;
+        process.io_duration = 0;
+    }
+
+    process.priority = (config.priorities > 0) ? (int)uniform_int(generator, 1, config.priorities) : 0;
+
+    return process;
+}
+
+// Writes one line in the "PID, size, arrival, burst, io_freq, io_duration[, priority]" format into
+// buffer and returns the end of what was written; buffer needs room for 7 * 12 characters
+inline char *format_process(char *buffer, const generated_process &process)
+{
+    unsigned int fields[] = {process.size, process.arrival_time, process.processing_time, process.io_freq, process.io_duration};
+
+    char *end = buffer + 84;
+    char *cursor = std::to_chars(buffer, end, process.PID).ptr;
+    for (unsigned int field : fields)
+    {
+        *cursor++ = ',';
+        *cursor++ = ' ';
+        cursor = std::to_chars(cursor, end, field).ptr;
+    }
+    if (process.priority > 0)
+    {
+        *cursor++ = ',';
+        *cursor++ = ' ';
+        cursor = std::to_chars(cursor, end, process.priority).ptr;
+    }
+    *cursor++ = '\n';
+    return cursor;
+}
+
+// Streams the whole trace to output through a fixed buffer
+inline bool write_workload(const workload_config &config, FILE *output)
+{
+    workload_generator generator = make_workload_generator(config);
+    std::vector<char> buffer(1 << 20);
+    std::size_t used = 0;
+
+    for (unsigned long long i = 0; i < config.count; i++)
+    {
+        if (used + 128 > buffer.size())
+        {
+            if (std::fwrite(buffer.data(), 1, used, output) != used)
+            {
+                return false;
+            }
+            used = 0;
+        }
+        used = format_process(buffer.data() + used, next_process(generator)) - buffer.data();
+    }
+
+    return std::fwrite(buffer.data(), 1, used, output) == used && std::fflush(output) == 0;
+}
+
+// Generates the trace directly as PCBs, for feeding the simulator without going through text
+inline std::vector<PCB> generate_processes(const workload_config &config)
+{
+    workload_generator generator = make_workload_generator(config);
+    std::vector<PCB> processes;
+    processes.reserve(config.count);
+
+    for (unsigned long long i = 0; i < config.count; i++)
+    {
+        generated_process process = next_process(generator);
+        int priority = (process.priority > 0) ? process.priority : process.PID;
+        processes.push_back(make_process(process.PID, process.size, process.arrival_time, process.processing_time,
+                                         process.io_freq, process.io_duration, priority));
+    }
+
+    return processes;
+}
+
+#endif